@@ -5,6 +5,7 @@
 #include <sys/time.h>
 #include <math.h>
 #include <time.h>
+#include <limits.h>
 
 /* ---------- CONSTANTS ---------- */
 
@@ -81,6 +82,9 @@
 #define INF_MIN                             -999999
 #define INF_MAX                             999999
 
+// Geometry
+#define FIXED_POINT_GEOMETRY                1       // Integer distances and truncated moves in hot loops
+
 /* ------------- DEBUG ------------ */
 
 #define DEBUG                               1
@@ -108,6 +112,24 @@
 #define M0_COPY_STATE                       1
 #define M0_REFRESH_OUT_MONSTERS             1
 #define M0_COMPUTE_SYMMETRY                 1
+#define M0_BELIEF                           1
+#define M0_BELIEF_NB_TRACK_MAX              64      // Max number of unseen monsters tracked
+#define M0_BELIEF_NB_PARTICLE               32      // Particles per unseen monster
+#define M0_BELIEF_CONTROL_RATIO             0.125   // Part of particles controlled toward my base
+#define M0_BELIEF_SPREAD_ANGLE              0.15    // Spawn trajectory uncertainty (radians)
+#define M0_BELIEF_CONFIDENCE_MIN            0.2
+#define M0_DECISION_CACHE                   1
+#define M0_CACHE_TOLERANCE                  100     // Max drift of an input before recomputing a decision
+#define M0_CACHE_AGE_MAX                    4       // Max number of rounds a decision is reused
+#define M0_PRECOMPUTE_TABLES                1
+#define M0_TABLE_DIST_MAX                   20480   // Greater than map diagonal
+#define M0_PACKED_MEMO                      1       // Keep previous round as a packed snapshot
+#define M0_VIEW_BITMAP                      1       // Visibility as a bitmap of fine cells
+#define M0_VIEW_CELL_SIZE                   125
+#define M0_VIEW_WIDTH                       (GAME_MAX_X / M0_VIEW_CELL_SIZE + 1)
+#define M0_VIEW_HEIGHT                      (GAME_MAX_Y / M0_VIEW_CELL_SIZE + 1)
+#define M0_VIEW_WORDS                       ((M0_VIEW_WIDTH + 63) / 64)
+#define M0_VIEW_STAMP_MAX                   (2 * (BASE_FOG_RADIUS / M0_VIEW_CELL_SIZE) + 3)
 
 // Exploration
 #define METHOD_1                            1
@@ -151,6 +173,16 @@
 #define M2_URGENT_PUSH_STEP_MIN             1
 #define M2_URGENT_ALWAYS_PUSH_OUT           1
 
+#define M2_DEFENSE_SOLVER                   1
+#define M2_SOLVER_DEPTH                     3       // Number of turns looked ahead
+#define M2_SOLVER_NB_HERO_MAX               2
+#define M2_SOLVER_NB_THREAT_MAX             5
+#define M2_SOLVER_HERO_RADIUS_FACTOR        1.3
+#define M2_SOLVER_MEMO_SIZE                 8192    // Must be a power of 2
+#define M2_SOLVER_NODE_MAX                  4000
+#define M2_SOLVER_DAMAGE_COST               10000
+#define M2_SOLVER_SPELL_COST                50
+
 #define M2_RESTRICT_DEFENDER_ATTACK         1
 
 #define M2_EVAL_POS_MONSTER_VALUE           100.0
@@ -253,6 +285,9 @@
 #define S_RUSH_ENEMY_POINT_MANA_COST        10
 #define S_RUSH_AVOID_KILLING_SPIDERS        1
 #define S_RUSH_MOBILE                       0
+#define S_RUSH_COMBO                        1
+#define S_RUSH_COMBO_SPELL_MAX              3       // Max number of spells in a kill combo
+#define S_RUSH_COMBO_TURN_MAX               2       // Max number of turns of a kill combo
 
 // Farm strategy
 #define S_FARM                              0
@@ -269,6 +304,13 @@
 #define randDouble(a,b) (double)(((rand() / (double)RAND_MAX) * ((b) - (a) + 1)) + (a))
 #define round(n) (int)(n > 0 ? ((n) + 0.5) : ((n) - 0.5))
 
+// Geometry
+#if FIXED_POINT_GEOMETRY
+    #define fastDistance(p1, p2) distancei(p1, p2)
+#else
+    #define fastDistance(p1, p2) distance(p1, p2)
+#endif
+
 // Time
 #define GET_TIME (gettimeofday(&ttt, NULL))
 #define START_TIME (startTime = TOP_TIME)
@@ -365,6 +407,117 @@ typedef struct node {
     Entity entities[NB_ENTITY_MAX];
 } Node;
 
+typedef struct decision {
+    int round;          // Round of decision
+    int age;            // Number of rounds decision has been reused
+    char mode;          // Hero mode when decided
+    int target;         // Target id or grid cell index
+    Point hero;         // Expected hero position next round
+    Point input;        // Expected input position next round
+    Point context;      // Centroid of monsters around decided point
+    int nbContext;      // Number of monsters around decided point
+    Point result;       // Decided point
+    int step;
+} Decision;
+
+typedef struct viewStamp {
+    int radius;                             // In cells
+    char inner[M0_VIEW_STAMP_MAX];          // Half width of row cells fully in view, -1 if none
+    char outer[M0_VIEW_STAMP_MAX];          // Half width of row cells partly in view
+} ViewStamp;
+
+typedef struct view {
+    ViewStamp heroStamp;
+    ViewStamp baseStamp;
+    unsigned long long inner[M0_VIEW_HEIGHT][M0_VIEW_WORDS];    // Cells fully in view this round
+    unsigned long long outer[M0_VIEW_HEIGHT][M0_VIEW_WORDS];    // Cells partly in view this round
+    unsigned long long ring[M1_MAX_AGE][M0_VIEW_HEIGHT][M0_VIEW_WORDS];
+    unsigned long long recent[M0_VIEW_HEIGHT][M0_VIEW_WORDS];   // Cells seen in last M1_MAX_AGE rounds
+} View;
+
+typedef struct packedEntity {
+    short id;
+    short x;
+    short y;
+    short vx;
+    short vy;
+    unsigned char health;
+    unsigned char healthMax;
+    unsigned char shield;
+    unsigned char flags;        // type:2 nearBase:2 threatFor:2 isControlled:1 visible:1
+} PackedEntity;
+
+typedef struct packedNode {
+    int round;
+    short nbEntities;
+    short health[NB_PLAYER];
+    short mana[NB_PLAYER];
+    short baseX[NB_PLAYER];
+    short baseY[NB_PLAYER];
+    PackedEntity entities[NB_ENTITY_MAX];   // Only first nbEntities are meaningful
+} PackedNode;
+
+typedef struct heroCache {
+    Decision target;    // Attack target and its interception
+    Decision multi;     // Multi target point
+    Decision explore;   // Exploration cell
+} HeroCache;
+
+typedef struct belief {
+    int nbTrack;
+    int id[M0_BELIEF_NB_TRACK_MAX];
+    float confidence[M0_BELIEF_NB_TRACK_MAX];
+    Point expected[M0_BELIEF_NB_TRACK_MAX];
+    float x[M0_BELIEF_NB_TRACK_MAX * M0_BELIEF_NB_PARTICLE];
+    float y[M0_BELIEF_NB_TRACK_MAX * M0_BELIEF_NB_PARTICLE];
+    float vx[M0_BELIEF_NB_TRACK_MAX * M0_BELIEF_NB_PARTICLE];
+    float vy[M0_BELIEF_NB_TRACK_MAX * M0_BELIEF_NB_PARTICLE];
+    float w[M0_BELIEF_NB_TRACK_MAX * M0_BELIEF_NB_PARTICLE];
+    short track[NB_ENTITY_MAX];     // Track index of each entity id, -1 if not tracked
+} Belief;
+
+typedef struct combo {
+    Entity* monster;    // Monster to deliver in enemy base
+    char nbTurn;        // Number of turns before monster reaches enemy base
+    char nbSpell;       // Total number of spells cast
+    char wind[2];       // Bitmask of heroes (index in data.heroes) casting wind on each turn
+    char control;       // Index of hero controlling the monster on first turn, -1 if none
+    Point nextPos;      // Monster position after first turn
+} Combo;
+
+typedef struct defenseState {
+    int mana;
+    Point heroes[M2_SOLVER_NB_HERO_MAX];
+    Point monsters[M2_SOLVER_NB_THREAT_MAX];
+    int health[M2_SOLVER_NB_THREAT_MAX];
+    int shield[M2_SOLVER_NB_THREAT_MAX];
+} DefenseState;
+
+typedef struct defenseMemo {
+    unsigned long long key;
+    int cost;
+    char depth;
+    char exact;         // Cost is exact, otherwise it is a lower bound
+    char actions[M2_SOLVER_NB_HERO_MAX];
+} DefenseMemo;
+
+typedef struct defenseSolver {
+    char nbHero;
+    char nbThreat;
+    Entity* heroes[M2_SOLVER_NB_HERO_MAX];
+    Entity* threats[M2_SOLVER_NB_THREAT_MAX];
+    Point dest[M2_SOLVER_NB_THREAT_MAX];
+    Point base;
+    Point opBase;
+    int nbNode;
+    DefenseMemo memo[M2_SOLVER_MEMO_SIZE];
+} DefenseSolver;
+
+typedef struct tables {
+    float evalPow12[M0_TABLE_DIST_MAX];                                    // 100 / (d + 1) ^ 1.2
+    float evalPow13[M0_TABLE_DIST_MAX];                                    // 100 / (d + 1) ^ 1.3
+} Tables;
+
 typedef struct game {
     int round;
     char orientation;
@@ -400,6 +553,54 @@ char heroRank(Entity*);
 int interception(Point*, Entity*, Entity*);
 Point orientedPosition(Point);
 
+// Combos
+char findKillCombo(Player*, int, char*, Combo*);
+void playKillCombo(Player*, Player*, Combo*);
+Point comboMonsterStep(Point, Point, Point, char, char);
+
+// Belief
+void initBelief(Belief*);
+void beliefObserve(Belief*, Node*, Node*);
+void beliefUpdate(Belief*, Node*);
+void beliefSpawn(Belief*, int, Point, Point, Point);
+void beliefRelease(Belief*, int);
+float beliefExpected(Belief*, int, Point*);
+
+// View
+void initView(View*);
+void initViewStamp(ViewStamp*, int);
+void computeView(View*, Node*);
+void stampView(View*, ViewStamp*, Point);
+void setViewSpan(unsigned long long*, int, int);
+char viewBit(unsigned long long (*)[M0_VIEW_WORDS], Point);
+int viewCountUnseen(View*, Point, Point, int*);
+
+// Packed nodes
+void packNode(PackedNode*, Node*);
+void unpackNode(Node*, PackedNode*);
+
+// Tables
+void initTables(Tables*);
+float tablePow(float*, float);
+
+// Targets
+char isTargetEligible(Entity*, Entity*);
+float targetEval(Entity*, Entity*);
+
+// Decision cache
+char isDecisionValid(Decision*, Entity*, Point);
+void saveDecision(Decision*, Entity*, int, Point, Point, Point, int, char);
+Point monsterCentroid(Point, int, int*);
+Point moveToward(Point, Point, int);
+void visitFog(Point);
+
+// Defense solver
+char solveBaseDefense(Player*, Player*);
+int defenseSearch(DefenseState*, int, int, char*);
+int defenseStep(DefenseState*, char*, DefenseState*);
+int defenseLeafCost(DefenseState*);
+unsigned long long defenseHash(DefenseState*, int);
+
 // Moves
 void wait(Player*, Entity*);
 void move(Player*, Entity*, Point);
@@ -423,14 +624,25 @@ char isRectangleInCircle(Point, int, Point, Point);
 char isPointInCircle(Point, int, Point);
 float getAngle(Point, Point);
 Point computeAnglePosition(Point, int, float);
+long long distance2i(Point, Point);
+int distancei(Point, Point);
+int isqrt(long long);
+Point normalizei(Point, Point, int);
+Point pushPoint(Point, Point, int);
 
 /* ---------- MAIN ---------- */
 // Core instances
 Game game;
 Node state;
 Node memo;
+PackedNode packedMemo;
 Data data;
 Grid grid;
+View view;
+DefenseSolver solver;
+Belief belief;
+HeroCache heroCache[NB_HEROES];
+Tables tables;
 
 // Entity state
 char entityState[NB_ENTITY_MAX];
@@ -462,8 +674,8 @@ int main() {
     for (int dy = -HERO_SPEED; dy <= HERO_SPEED; dy += M2_MULTI_TARGET_STEP) {
         for (int dx = -HERO_SPEED; dx <= HERO_SPEED; dx += M2_MULTI_TARGET_STEP) {
             Point dPos = { .x = dx, .y = dy };
-            float dist = distance(zeroPos, dPos);
-            if ( dist > HERO_SPEED) continue;
+            float dist = fastDistance(zeroPos, dPos);
+            if (!isPointInCircle(zeroPos, HERO_SPEED, dPos)) continue;
 
             Point* p = &moveGrid[nbMoveGrid++];
             p->x = dx;
@@ -496,6 +708,19 @@ int main() {
             SHOW_TIME("Début du calcul");
 
             #if METHOD_0
+                #if M0_COPY_STATE && M0_PACKED_MEMO
+                    // Restore previous round from its snapshot
+                    unpackNode(&memo, &packedMemo);
+                #endif
+                #if M0_VIEW_BITMAP
+                    // Stamp visibility discs of base and heroes
+                    computeView(&view, n);
+                #endif
+                #if M0_BELIEF
+                    // Track unseen monsters and advance their particles
+                    beliefObserve(&belief, n, &memo);
+                    beliefUpdate(&belief, n);
+                #endif
                 #if M0_COPY_STATE
                     // Refresh infos from previous round
                     refreshState(n, &memo);
@@ -585,8 +810,8 @@ int main() {
                 data.distBaseEntity[PLAYER_OP][m->id] = distance(op->basePos, m->pos);
 
                 // Nb monsters in bases
-                if (data.distBaseEntity[PLAYER_ME][m->id] < BASE_DETECT_RADIUS) data.nbMonsterInBase[PLAYER_ME]++;
-                if (data.distBaseEntity[PLAYER_OP][m->id] < BASE_DETECT_RADIUS) data.nbMonsterInBase[PLAYER_OP]++;
+                if (isPointInCircle(me->basePos, BASE_DETECT_RADIUS, m->pos)) data.nbMonsterInBase[PLAYER_ME]++;
+                if (isPointInCircle(op->basePos, BASE_DETECT_RADIUS, m->pos)) data.nbMonsterInBase[PLAYER_OP]++;
 
                 // Nb steps before monster is out of game
                 int nbStep = 0;
@@ -759,52 +984,67 @@ int main() {
                         }
                     }
 
-                    // Sure kill
-                    if (me->mana >= 2 * SPELL_COST) {
-                        for (int i = 0; i < data.nbMonster; i++) {
-                            Entity* m = data.monsters[i];
-                            if (data.distHeroEntity[frontHero->rank][m->id] > WIND_RADIUS) continue;
-                            if (data.distHeroEntity[midHero->rank][m->id] > WIND_RADIUS) continue;
-                            if (data.distBaseEntity[PLAYER_OP][m->id] > BASE_KILL_RADIUS + 2 * WIND_PUSH_FORCE + MONSTER_SPEED) continue;
-
-                            castWind(me, frontHero, m, op->basePos);
-                            castWind(me, midHero, m, op->basePos);
-
-                            frontHero->end = true;
-                            midHero->end = true;
-                            break;
+                    // Mana kept for the second turn of the combos started
+                    int comboReserve = 0;
+
+                    #if S_RUSH_COMBO
+                        // Deliver monsters in enemy base with wind / control combos
+                        // A monster is taken once, another combo on it would break its trajectory
+                        Combo combo;
+                        char comboTaken[NB_ENTITY_MAX] = { 0 };
+                        while (findKillCombo(op, me->mana - comboReserve, comboTaken, &combo)) {
+                            playKillCombo(me, op, &combo);
+                            comboTaken[combo.monster->id] = true;
+                            comboReserve += __builtin_popcount(combo.wind[1]) * SPELL_COST;
                         }
-                    }
-
-                    // Prepare sure kill
-                    if (me->mana >= 3 * SPELL_COST) {
-                        for (int i = 0; i < data.nbMonster; i++) {
-                            Entity* m = data.monsters[i];
-
-                            float distOpBaseMonster = data.distBaseEntity[PLAYER_OP][m->id];
-                            if (distOpBaseMonster > BASE_KILL_RADIUS + 3 * WIND_PUSH_FORCE + MONSTER_SPEED) continue;
+                    #else
+                        // Sure kill
+                        if (me->mana >= 2 * SPELL_COST) {
+                            for (int i = 0; i < data.nbMonster; i++) {
+                                Entity* m = data.monsters[i];
+                                if (data.distHeroEntity[frontHero->rank][m->id] > WIND_RADIUS) continue;
+                                if (data.distHeroEntity[midHero->rank][m->id] > WIND_RADIUS) continue;
+                                if (data.distBaseEntity[PLAYER_OP][m->id] > BASE_KILL_RADIUS + 2 * WIND_PUSH_FORCE + MONSTER_SPEED) continue;
 
-                            Point mNextPos = {
-                                .x = m->pos.x + WIND_PUSH_FORCE * (op->basePos.x - m->pos.x) / distOpBaseMonster,
-                                .y = m->pos.y + WIND_PUSH_FORCE * (op->basePos.y - m->pos.y) / distOpBaseMonster
-                            };
-                            float cast0 = data.distHeroEntity[frontHero->rank][m->id];
-                            float cast1 = data.distHeroEntity[midHero->rank][m->id];
-                            float dist0 = distance(mNextPos, frontHero->pos);
-                            float dist1 = distance(mNextPos, midHero->pos);
-                            if (cast0 < WIND_RADIUS && dist0 < WIND_RADIUS && dist1 < WIND_RADIUS + HERO_SPEED) {
-                                if (dist1 > WIND_RADIUS) move(me, midHero, mNextPos);
                                 castWind(me, frontHero, m, op->basePos);
-                                frontHero->end = true;
-                                midHero->end = true;
-                            } else if (cast1 < WIND_RADIUS && dist1 < WIND_RADIUS && dist0 < WIND_RADIUS + HERO_SPEED) {
-                                if (dist0 > WIND_RADIUS) move(me, frontHero, mNextPos);
                                 castWind(me, midHero, m, op->basePos);
+
                                 frontHero->end = true;
                                 midHero->end = true;
+                                break;
                             }
                         }
-                    }
+
+                        // Prepare sure kill
+                        if (me->mana >= 3 * SPELL_COST) {
+                            for (int i = 0; i < data.nbMonster; i++) {
+                                Entity* m = data.monsters[i];
+
+                                float distOpBaseMonster = data.distBaseEntity[PLAYER_OP][m->id];
+                                if (distOpBaseMonster > BASE_KILL_RADIUS + 3 * WIND_PUSH_FORCE + MONSTER_SPEED) continue;
+
+                                Point mNextPos = {
+                                    .x = m->pos.x + WIND_PUSH_FORCE * (op->basePos.x - m->pos.x) / distOpBaseMonster,
+                                    .y = m->pos.y + WIND_PUSH_FORCE * (op->basePos.y - m->pos.y) / distOpBaseMonster
+                                };
+                                float cast0 = data.distHeroEntity[frontHero->rank][m->id];
+                                float cast1 = data.distHeroEntity[midHero->rank][m->id];
+                                float dist0 = distance(mNextPos, frontHero->pos);
+                                float dist1 = distance(mNextPos, midHero->pos);
+                                if (cast0 < WIND_RADIUS && dist0 < WIND_RADIUS && dist1 < WIND_RADIUS + HERO_SPEED) {
+                                    if (dist1 > WIND_RADIUS) move(me, midHero, mNextPos);
+                                    castWind(me, frontHero, m, op->basePos);
+                                    frontHero->end = true;
+                                    midHero->end = true;
+                                } else if (cast1 < WIND_RADIUS && dist1 < WIND_RADIUS && dist0 < WIND_RADIUS + HERO_SPEED) {
+                                    if (dist0 > WIND_RADIUS) move(me, frontHero, mNextPos);
+                                    castWind(me, midHero, m, op->basePos);
+                                    frontHero->end = true;
+                                    midHero->end = true;
+                                }
+                            }
+                        }
+                    #endif
 
                     // Control monsters to prepare for rush
                     for (char i = 0; i < data.nbHero; i++) {
@@ -814,7 +1054,7 @@ int main() {
                         if (h->end) continue;
 
                         Entity* m = findBestMonsterToControl(h, CONTROL_RADIUS);
-                        if (m && me->mana >= S_RUSH_CONTROL_KEEP_MANA_MIN + SPELL_COST) {
+                        if (m && me->mana - comboReserve >= S_RUSH_CONTROL_KEEP_MANA_MIN + SPELL_COST) {
                             if (canCastSpell(me, h, m, CONTROL_RADIUS)) {
                                 // Point opBase = { .x = op->basePos.x + (game.orientation == GAME_TOP_LEFT ? -4000 : 4000), .y = op->basePos.y };
                                 castControl(me, h, m, orientedPosition(controlTo));
@@ -899,7 +1139,25 @@ int main() {
                         int ageMax = INF_MIN;
                     #endif
 
-                    for (int j = 0; j < GRID_HEIGHT; j++) {
+                    // Keep previous cell while hero is on its way, cell still unseen and monsters around hero did not move
+                    char exploreReused = false;
+                    #if M0_DECISION_CACHE
+                        Decision* dExplore = &heroCache[hero->rank].explore;
+                        int nbSeen = 0;
+                        Point seen = monsterCentroid(hero->pos, HERO_FOG_RADIUS, &nbSeen);
+                        if (nbSeen == dExplore->nbContext && isDecisionValid(dExplore, hero, seen)) {
+                            int ci = dExplore->target % GRID_WIDTH;
+                            int cj = dExplore->target / GRID_WIDTH;
+                            visitFog(hero->pos);
+                            if (grid.fog[cj][ci] != 0) {
+                                bestGrid.x = ci;
+                                bestGrid.y = cj;
+                                exploreReused = true;
+                            }
+                        }
+                    #endif
+
+                    for (int j = 0; j < GRID_HEIGHT && !exploreReused; j++) {
                         for (int i = 0; i < GRID_WIDTH; i++) {
                             if (hero->mode == M_RUSH && grid.rush[j][i] == 0) continue;
                             if (hero->mode == M_ATTACK && grid.attack[j][i] == 0) continue;
@@ -938,6 +1196,12 @@ int main() {
                             int age = grid.fog[j][i];
                             if (age < 0) age = 100;
                             float eval = age * 1000.0 / dist + grid.eval[j][i];
+                            #if M0_VIEW_BITMAP
+                                // Favor cells whose area was not seen lately
+                                int nbViewCell;
+                                int nbUnseen = viewCountUnseen(&view, cellCenter1, cellCenter2, &nbViewCell);
+                                eval -= age * 1000.0 / dist * (nbViewCell - nbUnseen) / (nbViewCell + 1);
+                            #endif
                             if (age > 0 && eval > bestEval) {
                         #else
                             float eval = 1000000.0 / dist + grid.Eval[j][i];
@@ -959,6 +1223,11 @@ int main() {
                         move(me, hero, bestGridPosition);
                         sprintf(mes[hero->rank], "Pat [%d, %d]", bestGrid.x, bestGrid.y);
                         grid.eval[bestGrid.y][bestGrid.x] -= 1000.0;
+
+                        #if M0_DECISION_CACHE
+                            saveDecision(dExplore, hero, bestGrid.y * GRID_WIDTH + bestGrid.x, bestGridPosition, seen, bestGridPosition, 0, exploreReused);
+                            dExplore->nbContext = nbSeen;
+                        #endif
                     }
                 }
 
@@ -984,7 +1253,13 @@ int main() {
                 #endif 
 
                 #if M2_URGENT_DEFENSE
-                    Entity* bestMonster = findClosestMonsterFromBase(me);
+                    char defenseSolved = false;
+                    #if M2_DEFENSE_SOLVER
+                        // Exact lookahead over threats heading for my base
+                        defenseSolved = solveBaseDefense(me, op);
+                    #endif
+
+                    Entity* bestMonster = defenseSolved ? NULL : findClosestMonsterFromBase(me);
                     if(bestMonster) {
                         // Entity* bestHero = findClosestHeroFromEntity(bestMonster);
                         Entity* bestHero = NULL;
@@ -1015,7 +1290,7 @@ int main() {
                             if (
                                 castOk &&
                                 canCastSpell(me, bestHero, bestMonster, WIND_RADIUS) &&
-                                data.distBaseEntity[PLAYER_ME][bestMonster->id] < BASE_DETECT_RADIUS
+                                isPointInCircle(me->basePos, BASE_DETECT_RADIUS, bestMonster->pos)
                             ) {
                                 castWind(me, bestHero, bestMonster, op->basePos);
                                 sprintf(mes[bestHero->rank], "Push %d", bestMonster->id);
@@ -1071,104 +1346,43 @@ int main() {
                     if (h->target > -1) continue;
 
                     Entity* bestTarget = NULL;
+
+                    // Previous target is kept while hero and target move as expected. It still
+                    // goes through the filters, and a better target makes it drop
+                    Entity* cached = NULL;
+                    #if M0_DECISION_CACHE
+                        Decision* dTarget = &heroCache[h->rank].target;
+                        cached = getEntity(n, dTarget->target);
+                        if (cached && (cached->type != ENTITY_MONSTER || cached->health <= 0 || !isDecisionValid(dTarget, h, cached->pos))) cached = NULL;
+                    #endif
+
                     float bestEval = INF_MIN;
                     for(int i = 0; i < data.nbMonster; i++) {
                         Entity* m = data.monsters[i];
+                        if (!isTargetEligible(h, m)) continue;
 
-                        float eval = 0.0;
-                        if (m->nbAttacker == 0) eval = 0.1;
-
-                        float heroMonsterDist = data.distHeroEntity[h->rank][m->id];
-                        float myBaseMonsterDist = data.distBaseEntity[PLAYER_ME][m->id];
-                        float opBaseMonsterDist = data.distBaseEntity[PLAYER_OP][m->id];
-
-                        // Find another hero
-                        #if M2_LEAVE_TARGET_TO_NEAREST
-                            char otherOk = 0;
-                            for (char e1 = 0; e1 < data.nbHero; e1++) {
-                                Entity* h2 = data.heroes[e1];
-                                if (h2->id == h->id) continue;
-
-                                if (heroMonsterDist > data.distHeroEntity[h2->rank][m->id]) otherOk = 1;
-                            }
-                            if (otherOk) continue;
-                        #endif
-
-                        // If hero too far, continue
-                        if (heroMonsterDist > WIND_RADIUS + (HERO_SPEED - MONSTER_SPEED) * myBaseMonsterDist / MONSTER_SPEED) continue;
-
-                        #if M2_STAY_NEAR_ENEMY
-                            if (h->mode == M_DEFENSE && data.enemyInBase) {
-                                if (data.distEnemyEntity[data.enemyInBase->rank][m->id] > M2_NEAR_ENEMY_DIST_MAX) continue;
-                            }
-                        #endif
-
-                        // If inside enemy base
-                        if (opBaseMonsterDist <= M8_INNER_ATTACK_RADIUS_FACTOR * BASE_DETECT_RADIUS) continue;
-
-                        #if M2_RESTRICT_DEFENDER_ATTACK
-                            if (h->mode == M_DEFENSE) {
-                                if (data.enemyInBase) {
-                                    if (myBaseMonsterDist > M1_INVASION_RADIUS_FACTOR * BASE_DETECT_RADIUS) continue;
-                                    if (data.distEnemyEntity[data.enemyInBase->rank][m->id] > CONTROL_RADIUS) continue;
-                                } else {
-                                    if (myBaseMonsterDist > M1_DEFENSE_RADIUS_FACTOR * BASE_DETECT_RADIUS) continue;
-                                }
-                            }
-                        #endif
+                        // Interception is only computed for a monster that would be the best target
+                        float eval = targetEval(h, m);
+                        if (eval <= bestEval) continue;
 
                         #if M2_IGNORE_IF_OUT
                             Point inter = { .x = m->pos.x, .y = m->pos.y, 0 };
-                            int interStep = interception(&inter, m, h);
+                            #if M0_DECISION_CACHE
+                                if (m == cached) inter = dTarget->result;
+                                else
+                            #endif
+                            interception(&inter, m, h);
 
                             Point relPos = { .x = inter.x - m->dest.x, .y = inter.y - m->dest.y };
                             if (!isInGame(relPos)) continue;
                         #endif
 
-                        // Attack near enemy base
-                        if (h->mode == M_ATTACK) {
-                            if (opBaseMonsterDist > M8_ATTACK_RADIUS_FACTOR * BASE_DETECT_RADIUS) continue;
-                            if (opBaseMonsterDist < M8_INNER_ATTACK_RADIUS_FACTOR * BASE_DETECT_RADIUS) continue;
-                            if (m->threatFor != MONSTER_THREAT_OP) {
-                                if (m->nbAttacker < M2_ATTACK_NB_THREAT_MAX) eval += 1000.0 / opBaseMonsterDist;
-                            }
-                            #if 0
-                            if (m->nearBase == MONSTER_THREAT_OP) {
-                                if (m->nbAttacker < M2_ATTACK_NB_THREAT_MAX) eval += 100.0 / opBaseMonsterDist;
-                            }
-                            if (m->threatFor == MONSTER_THREAT_OP) {
-                                if (m->nbAttacker < M2_ATTACK_NB_THREAT_MAX) eval += 10.0 / opBaseMonsterDist;
-                            }
-                            #endif
-                        }
-
-                        #if 0
-                        else if (h->mode == M_FARM) {
-                            if (opBaseMonsterDist < BASE_DETECT_RADIUS) continue;
-                            if (m->nbAttacker < M2_ATTACK_NB_THREAT_MAX) eval += 100.0 / myBaseMonsterDist;
-                        //#else
-                        // Farm near enemy base
-                        else if (h->rank < M8_NB_ENEMY_FARMER && game.round >= M8_FARM_ENEMY_ROUND_MIN) {
-                            if (m->nbAttacker < M2_ATTACK_NB_THREAT_MAX) eval += 1000.0 / opBaseMonsterDist;
-                        }
-                        #endif
-                        // Default
-                        else {
-                            if (m->threatFor == MONSTER_THREAT_ME) {
-                                if (m->nbAttacker < M2_ATTACK_NB_THREAT_MAX) eval += 1000.0 / myBaseMonsterDist;
-                            }
-                            if (m->nearBase == MONSTER_THREAT_ME) {
-                                if (m->nbAttacker < M2_ATTACK_NB_THREAT_MAX) eval += 10000.0 / myBaseMonsterDist;
-                            }
-                        }
-
-                        if (eval > 0.0) eval = eval / ( heroMonsterDist + 1.0);
-
-                        if (eval > bestEval) {
-                            bestEval = eval;
-                            bestTarget = m;
-                        }
+                        bestEval = eval;
+                        bestTarget = m;
                     }
+                    #if M0_DECISION_CACHE
+                        char targetReused = bestTarget && bestTarget == cached;
+                    #endif
 
                     if (bestTarget) {
                         bestTarget->nbAttacker++;
@@ -1182,13 +1396,20 @@ int main() {
                         if (bestTarget->health > ATTACK_DAMAGE || data.distHeroEntity[h->rank][bestTarget->id] > ATTACK_RADIUS)
                         #endif
                         {
+                            #if M0_DECISION_CACHE
+                                if (targetReused) {
+                                    inter = dTarget->result;
+                                    interStep = max(0, dTarget->step - 1);
+                                } else
+                            #endif
                             interStep = interception(&inter, bestTarget, h);
                             move(me, h, inter);
                             sprintf(mes[h->rank], "Int %d", bestTarget->id);
                         }
+                        Point targetInter = inter;
 
                         #if 1
-                            if (data.distBaseHero[PLAYER_OP][h->rank] < BASE_FOG_RADIUS) {
+                            if (isPointInCircle(op->basePos, BASE_FOG_RADIUS, h->pos)) {
                                 float distBaseSpider = data.distBaseEntity[PLAYER_OP][bestTarget->id];
                                 if (h->mode == M_ATTACK) {
                                     inter.x = bestTarget->pos.x + (WIND_RADIUS - 100) * (op->basePos.x - bestTarget->pos.x) / distBaseSpider;
@@ -1202,12 +1423,32 @@ int main() {
 
                         #if M2_MULTI_TARGET
                             if (interStep <= M2_MULTI_TARGET_STEP_MAX && h->mode != M_ATTACK) {
-                                optimizeMove(&inter, h, bestTarget, interStep);
+                                #if M0_DECISION_CACHE
+                                    // Keep multi target point while target and monsters around did not move
+                                    Decision* dMulti = &heroCache[h->rank].multi;
+                                    int nbContext = 0;
+                                    Point context = monsterCentroid(dMulti->result, HERO_SPEED + ATTACK_RADIUS, &nbContext);
+                                    char multiReused = dMulti->target == bestTarget->id && isDecisionValid(dMulti, h, inter) &&
+                                        nbContext == dMulti->nbContext && distance(context, dMulti->context) <= M0_CACHE_TOLERANCE;
+
+                                    if (multiReused) inter = dMulti->result;
+                                    else optimizeMove(&inter, h, bestTarget, interStep);
+
+                                    saveDecision(dMulti, h, bestTarget->id, inter, targetInter, inter, interStep, multiReused);
+                                    dMulti->context = monsterCentroid(inter, HERO_SPEED + ATTACK_RADIUS, &dMulti->nbContext);
+                                #else
+                                    optimizeMove(&inter, h, bestTarget, interStep);
+                                #endif
                                 move(me, h, inter);
                                 sprintf(mes[h->rank], "Int+ %d", bestTarget->id);
 
                             }
                         #endif
+
+                        #if M0_DECISION_CACHE
+                            Point nextTargetPos = { .x = bestTarget->pos.x + bestTarget->dest.x, .y = bestTarget->pos.y + bestTarget->dest.y };
+                            saveDecision(dTarget, h, bestTarget->id, heroBestMove(h)->pos, nextTargetPos, targetInter, interStep, targetReused);
+                        #endif
                     }
                 }
             #endif
@@ -1400,7 +1641,7 @@ int main() {
                         // Attack if can attack
                         // if (distMonsterEnemyBase < M8_ATTACK_RADIUS_FACTOR * BASE_DETECT_RADIUS) pushOk = true;
 
-                        if (data.strategy != M_ATTACK && distMonsterEnemyBase > BASE_DETECT_RADIUS) continue;
+                        if (data.strategy != M_ATTACK && !isPointInCircle(op->basePos, BASE_DETECT_RADIUS, m->pos)) continue;
 
                         #if M8_ALWAYS_PUSH_IN_BASE
                             if (distMonsterEnemyBase <= BASE_DETECT_RADIUS + WIND_PUSH_FORCE) pushOk = true;
@@ -1452,7 +1693,9 @@ int main() {
             }
 
             #if METHOD_0
-                #if M0_COPY_STATE
+                #if M0_COPY_STATE && M0_PACKED_MEMO
+                    packNode(&packedMemo, n);
+                #elif M0_COPY_STATE
                     memcpy(&memo, n, sizeof(Node));
                 #endif
             #endif
@@ -1488,6 +1731,18 @@ void initGame(Game* g) {
     for (int i = 0; i < NB_ENTITY_MAX; i++) {
         entityState[i] = STATE_UNTOUCHED;
     }
+    initBelief(&belief);
+    #if M0_PRECOMPUTE_TABLES
+        initTables(&tables);
+    #endif
+    #if M0_VIEW_BITMAP
+        initView(&view);
+    #endif
+    for (int i = 0; i < NB_HEROES; i++) {
+        heroCache[i].target.round = INF_MIN;
+        heroCache[i].multi.round = INF_MIN;
+        heroCache[i].explore.round = INF_MIN;
+    }
     for (int j = 0; j < GRID_HEIGHT; j++) {
         for (int i = 0; i < GRID_WIDTH; i++) {
             grid.fog[j][i] = -1;
@@ -1632,6 +1887,16 @@ void refreshState(Node* nDist, Node* nSrc) {
             }
             enDist->healthMax = max(enDist->healthMax, enSrc->healthMax);
         } else {
+            #if M0_BELIEF
+                Point expected = { .x = 0, .y = 0 };
+                float confidence = beliefExpected(&belief, enSrc->id, &expected);
+                if (confidence >= 0.0 && confidence < M0_BELIEF_CONFIDENCE_MIN) {
+                    entityState[enSrc->id] = STATE_DEAD;
+                    beliefRelease(&belief, enSrc->id);
+                    continue;
+                }
+            #endif
+
             enDist = &nDist->entities[nDist->nbEntities++];
             enDist->id = enSrc->id;
             enDist->type = ENTITY_MONSTER;
@@ -1641,7 +1906,13 @@ void refreshState(Node* nDist, Node* nSrc) {
             #endif
 
             enDist->pos.x = enSrc->pos.x + enSrc->dest.x;
-            enDist->pos.x = enSrc->pos.y + enSrc->dest.y;
+            enDist->pos.y = enSrc->pos.y + enSrc->dest.y;
+            #if M0_BELIEF
+                if (confidence >= 0.0) {
+                    enDist->pos.x = expected.x;
+                    enDist->pos.y = expected.y;
+                }
+            #endif
             enDist->shield = max(0, enSrc->shield - 1);
             enDist->isControlled = 0;
             enDist->health = enSrc->health;
@@ -1652,6 +1923,11 @@ void refreshState(Node* nDist, Node* nSrc) {
             enDist->visible = 0;
             entityState[enDist->id] = STATE_COMPUTED;
 
+            #if M0_BELIEF
+                // Particles out of game or in view are already pruned
+                if (confidence >= 0.0) continue;
+            #endif
+
             #if M0_REFRESH_OUT_MONSTERS
                 if (!wasInGame && !isInGame(enDist->pos)) {
             #else
@@ -1684,6 +1960,13 @@ void computeSymmetry(Node* n) {
             symEn->type = ENTITY_MONSTER;
             symEn->pos.x = GAME_MAX_X - en->pos.x;
             symEn->pos.y = GAME_MAX_Y - en->pos.y;
+            #if M0_BELIEF
+                Point expected;
+                if (beliefExpected(&belief, symId, &expected) >= M0_BELIEF_CONFIDENCE_MIN) {
+                    symEn->pos.x = expected.x;
+                    symEn->pos.y = expected.y;
+                }
+            #endif
             symEn->shield = 0;
             symEn->isControlled = 0;
             symEn->health = en->healthMax;
@@ -1878,6 +2161,14 @@ char isInGame(Point pos) {
 }
 
 char isInView(Node* n, Entity* e) {
+    #if M0_VIEW_BITMAP
+        // Exact check only on cells crossed by a disc border
+        if (isInGame(e->pos)) {
+            if (viewBit(view.inner, e->pos)) return 1;
+            if (!viewBit(view.outer, e->pos)) return 0;
+        }
+    #endif
+
     if (distance(n->players[PLAYER_ME].basePos, e->pos) <= BASE_FOG_RADIUS) return 1;
 
     for(int i = 0; i < n->nbEntities; i++) {
@@ -1930,13 +2221,14 @@ void move(Player* p, Entity* h, Point po) {
 int optimizeMove(Point* inter, Entity* hero, Entity* target, int step) {
     float bestEval = INF_MIN;
     int bestPack = 0;
+    Point bestPos = *inter;
     for (int d = 0; d < nbMoveGrid; d++) {
         Point* p = &moveGrid[d];
         if (p->dist > HERO_SPEED) continue;
 
         Point nextHeroPos = { .x = hero->pos.x + p->x, .y = hero->pos.y + p->y };
 
-        float optDist = distance(nextHeroPos, *inter);
+        float optDist = fastDistance(nextHeroPos, *inter);
         char optStep = optDist / HERO_SPEED;
         if (optStep > step) continue;
 
@@ -1954,19 +2246,23 @@ int optimizeMove(Point* inter, Entity* hero, Entity* target, int step) {
             Entity* m = data.monsters[k];
             if (target && m->id == target->id) continue;
 
-            float dist = distance(nextHeroPos, m->pos);
+            #if FIXED_POINT_GEOMETRY
+                char inRange = distance2i(nextHeroPos, m->pos) <= ATTACK_RADIUS * ATTACK_RADIUS;
+            #else
+                char inRange = distance(nextHeroPos, m->pos) <= ATTACK_RADIUS;
+            #endif
 
             #if M8_AVOID_KILLING_SPIDERS
-                if (hero->mode == M_ATTACK && dist <= ATTACK_RADIUS) continue;
+                if (hero->mode == M_ATTACK && inRange) continue;
             #endif
 
             #if S_RUSH_AVOID_KILLING_SPIDERS
-                if (hero->mode == M_RUSH && dist <= ATTACK_RADIUS) continue;
+                if (hero->mode == M_RUSH && inRange) continue;
             #endif
-                else if (dist > ATTACK_RADIUS) continue;
+                else if (!inRange) continue;
 
             packedTarget[nbPackedTarget] = m;
-            distPackedTarget[nbPackedTarget++] = dist;
+            distPackedTarget[nbPackedTarget++] = fastDistance(nextHeroPos, m->pos);
         }
 
         // log("IN LOOP %d -- ", d);
@@ -1983,14 +2279,23 @@ int optimizeMove(Point* inter, Entity* hero, Entity* target, int step) {
         #endif
 
         if (evalTargetOK) {
-            for (char k = 0; k < nbPackedTarget; k++) {
+            for (int k = 0; k < nbPackedTarget; k++) {
                 Entity* pt = packedTarget[k];
+            #if M0_PRECOMPUTE_TABLES
+                if ( pt->id == target->id) evalTarget += tablePow(tables.evalPow13, distPackedTarget[k]);
+                evalTarget += tablePow(tables.evalPow12, distPackedTarget[k]);
+            #else
                 if ( pt->id == target->id) evalTarget += 100.0 / pow(distPackedTarget[k] + 1.0, 1.3);
                 evalTarget += 100.0 / pow(distPackedTarget[k] + 1.0, 1.2);
+            #endif
             }
         }
         else {
+        #if M0_PRECOMPUTE_TABLES
+            evalTarget += tablePow(tables.evalPow12, optDist);
+        #else
             evalTarget += 100.0 / pow(optDist + 1.0, 1.2);
+        #endif
         }
 
         if (nbPackedTarget > bestPack) bestPack = nbPackedTarget;
@@ -2008,10 +2313,11 @@ int optimizeMove(Point* inter, Entity* hero, Entity* target, int step) {
         if (eval > bestEval) {
             // log("TEST EVAL %d\n", d);
             bestEval = eval;
-            inter = &nextHeroPos;
+            bestPos = nextHeroPos;
         }
     }
 
+    *inter = bestPos;
     return bestPack;
 }
 
@@ -2058,7 +2364,7 @@ int interception(Point* inter, Entity* target, Entity* hero) {
         next.x += target->dest.x;
         next.y += target->dest.y;
 
-        float dist = distance(hero->pos, next);
+        float dist = fastDistance(hero->pos, next);
         int step = dist / HERO_SPEED;
         if (step <= s) {
             inter->x = next.x;
@@ -2081,6 +2387,970 @@ Point orientedPosition(Point pos) {
     return orientedPos;
 }
 
+/* ---------- BELIEF FUNCTIONS -------------*/
+
+void initBelief(Belief* b) {
+    b->nbTrack = 0;
+    for (int i = 0; i < NB_ENTITY_MAX; i++) b->track[i] = -1;
+}
+
+// Release tracks of visible monsters, spawn tracks for monsters gone out of view and their symmetric
+void beliefObserve(Belief* b, Node* n, Node* prev) {
+    Point myBase = n->players[PLAYER_ME].basePos;
+
+    for (int i = 0; i < n->nbEntities; i++) {
+        Entity* en = &n->entities[i];
+        if (en->type != ENTITY_MONSTER) continue;
+        beliefRelease(b, en->id);
+    }
+
+    for (int i = 0; i < prev->nbEntities; i++) {
+        Entity* en = &prev->entities[i];
+        if (en->type != ENTITY_MONSTER) continue;
+        if (entityState[en->id] < 0) continue;
+        if (getEntity(n, en->id)) continue;
+
+        beliefSpawn(b, en->id, en->pos, en->dest, myBase);
+    }
+
+    // Symmetric spawn, positioned on previous round to be advanced with other tracks
+    for (int i = 0; i < n->nbEntities; i++) {
+        Entity* en = &n->entities[i];
+        if (en->type != ENTITY_MONSTER) continue;
+
+        int symId = en->id + (en->id % 2 == 0 ? 1 : -1);
+        if (symId < 0 || symId >= NB_ENTITY_MAX) continue;
+        if (entityState[symId] < 0) continue;
+        if (getEntity(n, symId)) continue;
+
+        Point symPos = { .x = GAME_MAX_X - en->pos.x + en->dest.x, .y = GAME_MAX_Y - en->pos.y + en->dest.y };
+        Point symDest = { .x = -en->dest.x, .y = -en->dest.y };
+        beliefSpawn(b, symId, symPos, symDest, myBase);
+    }
+}
+
+void beliefSpawn(Belief* b, int id, Point pos, Point dest, Point myBase) {
+    if (id < 0 || id >= NB_ENTITY_MAX) return;
+    if (b->track[id] > -1) return;
+    if (b->nbTrack == M0_BELIEF_NB_TRACK_MAX) return;
+
+    int t = b->nbTrack++;
+    b->id[t] = id;
+    b->track[id] = t;
+    b->confidence[t] = 1.0;
+    b->expected[t] = pos;
+
+    float speed = sqrt(dest.x * dest.x + dest.y * dest.y);
+    float angle = atan2(dest.y, dest.x);
+    float distBase = distance(pos, myBase) + 1.0;
+    int nbControlled = M0_BELIEF_NB_PARTICLE * M0_BELIEF_CONTROL_RATIO;
+
+    for (int p = 0; p < M0_BELIEF_NB_PARTICLE; p++) {
+        int i = t * M0_BELIEF_NB_PARTICLE + p;
+        b->x[i] = pos.x;
+        b->y[i] = pos.y;
+        b->w[i] = 1.0 / M0_BELIEF_NB_PARTICLE;
+
+        if (p < nbControlled) {
+            // Controlled by enemy toward my base
+            b->vx[i] = MONSTER_SPEED * (myBase.x - pos.x) / distBase;
+            b->vy[i] = MONSTER_SPEED * (myBase.y - pos.y) / distBase;
+        } else {
+            // Drifting on its trajectory, with some angle uncertainty
+            float a = angle + M0_BELIEF_SPREAD_ANGLE * (2.0 * rand() / RAND_MAX - 1.0);
+            b->vx[i] = speed * cos(a);
+            b->vy[i] = speed * sin(a);
+        }
+    }
+}
+
+void beliefRelease(Belief* b, int id) {
+    if (id < 0 || id >= NB_ENTITY_MAX) return;
+    int t = b->track[id];
+    if (t < 0) return;
+
+    // Move last track in the free slot
+    int last = --b->nbTrack;
+    b->track[id] = -1;
+    if (t == last) return;
+
+    int src = last * M0_BELIEF_NB_PARTICLE;
+    int dst = t * M0_BELIEF_NB_PARTICLE;
+    size_t size = M0_BELIEF_NB_PARTICLE * sizeof(float);
+    memcpy(&b->x[dst], &b->x[src], size);
+    memcpy(&b->y[dst], &b->y[src], size);
+    memcpy(&b->vx[dst], &b->vx[src], size);
+    memcpy(&b->vy[dst], &b->vy[src], size);
+    memcpy(&b->w[dst], &b->w[src], size);
+    b->id[t] = b->id[last];
+    b->confidence[t] = b->confidence[last];
+    b->expected[t] = b->expected[last];
+    b->track[b->id[t]] = t;
+}
+
+// Advance all particles one round and prune those we should see
+void beliefUpdate(Belief* b, Node* n) {
+    int nb = b->nbTrack * M0_BELIEF_NB_PARTICLE;
+    if (nb == 0) return;
+
+    float baseX[NB_PLAYER];
+    float baseY[NB_PLAYER];
+    for (int p = 0; p < NB_PLAYER; p++) {
+        baseX[p] = n->players[p].basePos.x;
+        baseY[p] = n->players[p].basePos.y;
+    }
+
+    // Move, monsters entering a base detect radius retarget the base
+    const float detect2 = (float)BASE_DETECT_RADIUS * BASE_DETECT_RADIUS;
+    for (int p = 0; p < NB_PLAYER; p++) {
+        for (int i = 0; i < nb; i++) {
+            float dx = baseX[p] - b->x[i];
+            float dy = baseY[p] - b->y[i];
+            float d2 = dx * dx + dy * dy;
+            float k = MONSTER_SPEED / sqrtf(d2 + 1.0f);
+            b->vx[i] = d2 <= detect2 ? dx * k : b->vx[i];
+            b->vy[i] = d2 <= detect2 ? dy * k : b->vy[i];
+        }
+    }
+    for (int i = 0; i < nb; i++) {
+        b->x[i] += b->vx[i];
+        b->y[i] += b->vy[i];
+        char inGame = b->x[i] >= 0 && b->x[i] <= GAME_MAX_X && b->y[i] >= 0 && b->y[i] <= GAME_MAX_Y;
+        b->w[i] = inGame ? b->w[i] : 0.0f;
+    }
+
+    // Prune particles inside our visibility discs
+    float discX[NB_HEROES + 1];
+    float discY[NB_HEROES + 1];
+    float discR2[NB_HEROES + 1];
+    int nbDisc = 0;
+    discX[nbDisc] = baseX[PLAYER_ME];
+    discY[nbDisc] = baseY[PLAYER_ME];
+    discR2[nbDisc++] = (float)BASE_FOG_RADIUS * BASE_FOG_RADIUS;
+    for (int e = 0; e < n->nbEntities && nbDisc <= NB_HEROES; e++) {
+        Entity* h = &n->entities[e];
+        if (h->type != ENTITY_HERO_ME) continue;
+        discX[nbDisc] = h->pos.x;
+        discY[nbDisc] = h->pos.y;
+        discR2[nbDisc++] = (float)HERO_FOG_RADIUS * HERO_FOG_RADIUS;
+    }
+    for (int d = 0; d < nbDisc; d++) {
+        for (int i = 0; i < nb; i++) {
+            float dx = discX[d] - b->x[i];
+            float dy = discY[d] - b->y[i];
+            b->w[i] = dx * dx + dy * dy <= discR2[d] ? 0.0f : b->w[i];
+        }
+    }
+
+    // Expected position and confidence of each track
+    for (int t = 0; t < b->nbTrack; t++) {
+        float sumW = 0.0;
+        float sumX = 0.0;
+        float sumY = 0.0;
+        for (int p = t * M0_BELIEF_NB_PARTICLE; p < (t + 1) * M0_BELIEF_NB_PARTICLE; p++) {
+            sumW += b->w[p];
+            sumX += b->w[p] * b->x[p];
+            sumY += b->w[p] * b->y[p];
+        }
+
+        b->confidence[t] = sumW;
+        if (sumW > 0.0) {
+            b->expected[t].x = sumX / sumW;
+            b->expected[t].y = sumY / sumW;
+        }
+    }
+}
+
+// Confidence of monster expected position, -1 if monster is not tracked
+float beliefExpected(Belief* b, int id, Point* pos) {
+    if (id < 0 || id >= NB_ENTITY_MAX) return -1.0;
+    int t = b->track[id];
+    if (t < 0) return -1.0;
+
+    *pos = b->expected[t];
+    return b->confidence[t];
+}
+
+/* ---------- VIEW FUNCTIONS -------------*/
+
+void initView(View* v) {
+    memset(v, 0, sizeof(View));
+    initViewStamp(&v->heroStamp, HERO_FOG_RADIUS);
+    initViewStamp(&v->baseStamp, BASE_FOG_RADIUS);
+}
+
+// Row spans of a disc, for a center anywhere in the stamp center cell
+void initViewStamp(ViewStamp* s, int radius) {
+    long long r2 = (long long)radius * radius;
+    s->radius = radius / M0_VIEW_CELL_SIZE + 1;
+
+    for (int dj = -s->radius; dj <= s->radius; dj++) {
+        long long yFar = (long long)(abs(dj) + 1) * M0_VIEW_CELL_SIZE;
+        long long yNear = (long long)max(abs(dj) - 1, 0) * M0_VIEW_CELL_SIZE;
+        char inner = -1;
+        char outer = -1;
+        for (int di = 0; di <= s->radius; di++) {
+            long long xFar = (long long)(di + 1) * M0_VIEW_CELL_SIZE;
+            long long xNear = (long long)max(di - 1, 0) * M0_VIEW_CELL_SIZE;
+            if (xFar * xFar + yFar * yFar <= r2) inner = di;
+            if (xNear * xNear + yNear * yNear <= r2) outer = di;
+        }
+        s->inner[dj + s->radius] = inner;
+        s->outer[dj + s->radius] = outer;
+    }
+}
+
+void computeView(View* v, Node* n) {
+    memset(v->inner, 0, sizeof(v->inner));
+    memset(v->outer, 0, sizeof(v->outer));
+
+    stampView(v, &v->baseStamp, n->players[PLAYER_ME].basePos);
+    for (int i = 0; i < n->nbEntities; i++) {
+        Entity* h = &n->entities[i];
+        if (h->type != ENTITY_HERO_ME) continue;
+        stampView(v, &v->heroStamp, h->pos);
+    }
+
+    // Keep cells seen this round in the ring of last rounds
+    unsigned long long (*seen)[M0_VIEW_WORDS] = v->ring[n->round % M1_MAX_AGE];
+    memcpy(seen, v->inner, sizeof(v->inner));
+    memset(v->recent, 0, sizeof(v->recent));
+    for (int a = 0; a < M1_MAX_AGE; a++) {
+        for (int j = 0; j < M0_VIEW_HEIGHT; j++) {
+            for (int w = 0; w < M0_VIEW_WORDS; w++) v->recent[j][w] |= v->ring[a][j][w];
+        }
+    }
+}
+
+// Or a disc stamp at a position
+void stampView(View* v, ViewStamp* s, Point pos) {
+    int ci = max(0, min(M0_VIEW_WIDTH - 1, pos.x / M0_VIEW_CELL_SIZE));
+    int cj = max(0, min(M0_VIEW_HEIGHT - 1, pos.y / M0_VIEW_CELL_SIZE));
+
+    for (int dj = -s->radius; dj <= s->radius; dj++) {
+        int j = cj + dj;
+        if (j < 0 || j >= M0_VIEW_HEIGHT) continue;
+
+        char in = s->inner[dj + s->radius];
+        char out = s->outer[dj + s->radius];
+        if (in >= 0) setViewSpan(v->inner[j], ci - in, ci + in);
+        if (out >= 0) setViewSpan(v->outer[j], ci - out, ci + out);
+    }
+}
+
+void setViewSpan(unsigned long long* row, int i0, int i1) {
+    i0 = max(i0, 0);
+    i1 = min(i1, M0_VIEW_WIDTH - 1);
+
+    for (int w = i0 / 64; w <= i1 / 64; w++) {
+        int b0 = w == i0 / 64 ? i0 % 64 : 0;
+        int b1 = w == i1 / 64 ? i1 % 64 : 63;
+        unsigned long long mask = (b1 == 63 ? ~0ULL : (1ULL << (b1 + 1)) - 1) & ~((1ULL << b0) - 1);
+        row[w] |= mask;
+    }
+}
+
+char viewBit(unsigned long long (*bits)[M0_VIEW_WORDS], Point pos) {
+    int i = pos.x / M0_VIEW_CELL_SIZE;
+    int j = pos.y / M0_VIEW_CELL_SIZE;
+
+    return bits[j][i / 64] >> (i % 64) & 1;
+}
+
+// Number of cells in a rectangle not seen in last rounds
+int viewCountUnseen(View* v, Point pos1, Point pos2, int* nbCell) {
+    int i0 = max(0, pos1.x / M0_VIEW_CELL_SIZE);
+    int i1 = min(M0_VIEW_WIDTH - 1, pos2.x / M0_VIEW_CELL_SIZE);
+    int j0 = max(0, pos1.y / M0_VIEW_CELL_SIZE);
+    int j1 = min(M0_VIEW_HEIGHT - 1, pos2.y / M0_VIEW_CELL_SIZE);
+
+    *nbCell = 0;
+    if (i0 > i1 || j0 > j1) return 0;
+
+    unsigned long long mask[M0_VIEW_WORDS] = { 0 };
+    setViewSpan(mask, i0, i1);
+
+    int nbSeen = 0;
+    for (int j = j0; j <= j1; j++) {
+        for (int w = 0; w < M0_VIEW_WORDS; w++) nbSeen += __builtin_popcountll(v->recent[j][w] & mask[w]);
+    }
+
+    *nbCell = (i1 - i0 + 1) * (j1 - j0 + 1);
+    return *nbCell - nbSeen;
+}
+
+/* ---------- PACKED NODE FUNCTIONS -------------*/
+
+void packNode(PackedNode* pn, Node* n) {
+    pn->round = n->round;
+    pn->nbEntities = n->nbEntities;
+    for (int i = 0; i < NB_PLAYER; i++) {
+        Player* p = &n->players[i];
+        pn->health[i] = p->health;
+        pn->mana[i] = min(p->mana, SHRT_MAX);
+        pn->baseX[i] = p->basePos.x;
+        pn->baseY[i] = p->basePos.y;
+    }
+
+    for (int i = 0; i < n->nbEntities; i++) {
+        Entity* e = &n->entities[i];
+        PackedEntity* pe = &pn->entities[i];
+        pe->id = e->id;
+        pe->x = max(SHRT_MIN, min(SHRT_MAX, e->pos.x));
+        pe->y = max(SHRT_MIN, min(SHRT_MAX, e->pos.y));
+        pe->vx = e->dest.x;
+        pe->vy = e->dest.y;
+        pe->health = max(0, min(UCHAR_MAX, e->health));
+        pe->healthMax = max(0, min(UCHAR_MAX, e->healthMax));
+        pe->shield = max(0, e->shield);
+        pe->flags = (e->type & 3)
+            | (e->nearBase & 3) << 2
+            | (e->threatFor & 3) << 4
+            | (e->isControlled ? 1 : 0) << 6
+            | (e->visible ? 1 : 0) << 7;
+    }
+}
+
+// Round state of entities is reset, as it is after readInputs
+void unpackNode(Node* n, PackedNode* pn) {
+    n->round = pn->round;
+    n->nbEntities = pn->nbEntities;
+    for (int i = 0; i < NB_PLAYER; i++) {
+        Player* p = &n->players[i];
+        p->id = i;
+        p->health = pn->health[i];
+        p->mana = pn->mana[i];
+        p->basePos.x = pn->baseX[i];
+        p->basePos.y = pn->baseY[i];
+    }
+
+    for (int i = 0; i < pn->nbEntities; i++) {
+        PackedEntity* pe = &pn->entities[i];
+        Entity* e = &n->entities[i];
+        e->id = pe->id;
+        e->type = pe->flags & 3;
+        e->rank = e->type == ENTITY_MONSTER ? 0 : heroRank(e);
+        e->pos.x = pe->x;
+        e->pos.y = pe->y;
+        e->pos.dist = 0;
+        e->dest.x = pe->vx;
+        e->dest.y = pe->vy;
+        e->dest.dist = 0;
+        e->health = pe->health;
+        e->healthMax = pe->healthMax;
+        e->shield = pe->shield;
+        e->nearBase = pe->flags >> 2 & 3;
+        e->threatFor = pe->flags >> 4 & 3;
+        e->isControlled = pe->flags >> 6 & 1;
+        e->visible = pe->flags >> 7 & 1;
+        e->nbAttacker = 0;
+        e->target = -1;
+        e->mode = -1;
+        e->modeRank = 0;
+        e->end = false;
+    }
+}
+
+/* ---------- TABLE FUNCTIONS -------------*/
+
+// Static weights computed once at turn zero
+void initTables(Tables* t) {
+    // Target evaluation weights of optimizeMove
+    for (int d = 0; d < M0_TABLE_DIST_MAX; d++) {
+        t->evalPow12[d] = 100.0 / pow(d + 1.0, 1.2);
+        t->evalPow13[d] = 100.0 / pow(d + 1.0, 1.3);
+    }
+}
+
+float tablePow(float* t, float dist) {
+    int d = dist;
+    if (d < 0) d = 0;
+    if (d >= M0_TABLE_DIST_MAX) d = M0_TABLE_DIST_MAX - 1;
+
+    return t[d];
+}
+
+/* ---------- COMBO FUNCTIONS -------------*/
+
+// Monster position after one turn in the referee order: nbWind winds push it, then it moves.
+// toBase is set when it was controlled toward base on previous turn, control being applied
+// at the start of the next turn. Winds push along the base direction, so it is unchanged.
+Point comboMonsterStep(Point pos, Point dest, Point base, char nbWind, char toBase) {
+    if (nbWind > 0) pos = pushPoint(pos, base, nbWind * WIND_PUSH_FORCE);
+
+    if (toBase || isPointInCircle(base, BASE_DETECT_RADIUS, pos)) {
+        if (isPointInCircle(base, MONSTER_SPEED, pos)) {
+            pos.x = base.x;
+            pos.y = base.y;
+        } else {
+            pos = pushPoint(pos, base, MONSTER_SPEED);
+        }
+    } else {
+        pos.x += dest.x;
+        pos.y += dest.y;
+    }
+
+    pos.dist = fastDistance(pos, base);
+    return pos;
+}
+
+// Find the cheapest sequence of winds / controls delivering a monster not taken yet in enemy base,
+// spells of both turns being paid from mana
+char findKillCombo(Player* op, int mana, char* taken, Combo* best) {
+    int spellMax = min(S_RUSH_COMBO_SPELL_MAX, mana / SPELL_COST);
+    if (spellMax <= 0) return false;
+
+    char freeMask = 0;
+    for (int i = 0; i < data.nbHero; i++) {
+        if (!data.heroes[i]->end) freeMask |= 1 << i;
+    }
+    if (!freeMask) return false;
+
+    int reachMax = BASE_KILL_RADIUS + spellMax * WIND_PUSH_FORCE + S_RUSH_COMBO_TURN_MAX * MONSTER_SPEED;
+
+    best->monster = NULL;
+    for (int k = 0; k < data.nbMonster; k++) {
+        Entity* m = data.monsters[k];
+        if (taken[m->id]) continue;
+        if (data.distBaseEntity[PLAYER_OP][m->id] > reachMax) continue;
+        if (m->shield >= S_RUSH_COMBO_TURN_MAX) continue;
+
+        // Heroes able to cast on first turn
+        char windMask1 = 0;
+        char controlMask1 = 0;
+        if (m->shield <= 0) {
+            for (int i = 0; i < data.nbHero; i++) {
+                if (!(freeMask & (1 << i))) continue;
+                if (isPointInCircle(data.heroes[i]->pos, WIND_RADIUS, m->pos)) windMask1 |= 1 << i;
+                if (isPointInCircle(data.heroes[i]->pos, CONTROL_RADIUS, m->pos) && !m->isControlled) controlMask1 |= 1 << i;
+            }
+        }
+
+        for (char wind1 = windMask1; ; wind1 = (wind1 - 1) & windMask1) {
+            char nbWind1 = __builtin_popcount(wind1);
+
+            for (char control = -1; control < data.nbHero; control++) {
+                if (control > -1 && ((wind1 & (1 << control)) || !(controlMask1 & (1 << control)))) continue;
+
+                char nbSpell1 = nbWind1 + (control > -1);
+                if (nbSpell1 > spellMax) continue;
+
+                // A control only steers the monster from next turn on
+                Point pos1 = comboMonsterStep(m->pos, m->dest, op->basePos, nbWind1, false);
+                if (isPointInCircle(op->basePos, BASE_KILL_RADIUS, pos1)) {
+                    if (nbSpell1 == 0) continue;    // Monster does not need us
+                    if (!best->monster || best->nbTurn > 1 || nbSpell1 < best->nbSpell) {
+                        best->monster = m;
+                        best->nbTurn = 1;
+                        best->nbSpell = nbSpell1;
+                        best->wind[0] = wind1;
+                        best->wind[1] = 0;
+                        best->control = control;
+                        best->nextPos = pos1;
+                    }
+                    continue;
+                }
+
+                // Second turn, heroes not casting on first turn can move closer
+                if (S_RUSH_COMBO_TURN_MAX < 2 || m->shield > 1) continue;
+                int spellLeft = spellMax - nbSpell1;
+                if (pos1.dist > BASE_KILL_RADIUS + spellLeft * WIND_PUSH_FORCE + MONSTER_SPEED) continue;
+                if (best->monster && best->nbTurn == 1) continue;
+
+                char windMask2 = 0;
+                for (int i = 0; i < data.nbHero; i++) {
+                    if (!(freeMask & (1 << i))) continue;
+                    char hasCast = (wind1 & (1 << i)) || control == i;
+                    if (isPointInCircle(data.heroes[i]->pos, WIND_RADIUS + (hasCast ? 0 : HERO_SPEED), pos1)) windMask2 |= 1 << i;
+                }
+
+                // No wind at all on second turn may do, once the control steers the monster
+                for (char wind2 = 0; wind2 <= windMask2; wind2++) {
+                    if (wind2 & ~windMask2) continue;
+
+                    char nbSpell = nbSpell1 + __builtin_popcount(wind2);
+                    if (nbSpell == 0 || nbSpell > spellMax) continue;
+                    if (best->monster && nbSpell >= best->nbSpell) continue;
+
+                    Point pos2 = comboMonsterStep(pos1, m->dest, op->basePos, __builtin_popcount(wind2), control > -1);
+                    if (!isPointInCircle(op->basePos, BASE_KILL_RADIUS, pos2)) continue;
+
+                    best->monster = m;
+                    best->nbTurn = 2;
+                    best->nbSpell = nbSpell;
+                    best->wind[0] = wind1;
+                    best->wind[1] = wind2;
+                    best->control = control;
+                    best->nextPos = pos1;
+                }
+            }
+
+            if (wind1 == 0) break;
+        }
+    }
+
+    return best->monster != NULL;
+}
+
+// Apply first turn of a kill combo
+void playKillCombo(Player* me, Player* op, Combo* c) {
+    for (int i = 0; i < data.nbHero; i++) {
+        Entity* h = data.heroes[i];
+        if (c->wind[0] & (1 << i)) {
+            castWind(me, h, c->monster, op->basePos);
+        } else if (c->control == i) {
+            castControl(me, h, c->monster, op->basePos);
+        } else if (c->wind[1] & (1 << i)) {
+            move(me, h, c->nextPos);
+        } else {
+            continue;
+        }
+
+        sprintf(mes[h->rank], "Combo %d", c->monster->id);
+        h->end = true;
+    }
+}
+
+/* ---------- TARGET FUNCTIONS -------------*/
+
+// Monster a hero may attack
+char isTargetEligible(Entity* h, Entity* m) {
+    float heroMonsterDist = data.distHeroEntity[h->rank][m->id];
+    float myBaseMonsterDist = data.distBaseEntity[PLAYER_ME][m->id];
+    float opBaseMonsterDist = data.distBaseEntity[PLAYER_OP][m->id];
+
+    // Find another hero
+    #if M2_LEAVE_TARGET_TO_NEAREST
+        for (int e1 = 0; e1 < data.nbHero; e1++) {
+            Entity* h2 = data.heroes[e1];
+            if (h2->id == h->id) continue;
+
+            if (heroMonsterDist > data.distHeroEntity[h2->rank][m->id]) return false;
+        }
+    #endif
+
+    // If hero too far
+    if (heroMonsterDist > WIND_RADIUS + (HERO_SPEED - MONSTER_SPEED) * myBaseMonsterDist / MONSTER_SPEED) return false;
+
+    #if M2_STAY_NEAR_ENEMY
+        if (h->mode == M_DEFENSE && data.enemyInBase) {
+            if (data.distEnemyEntity[data.enemyInBase->rank][m->id] > M2_NEAR_ENEMY_DIST_MAX) return false;
+        }
+    #endif
+
+    // If inside enemy base
+    if (opBaseMonsterDist <= M8_INNER_ATTACK_RADIUS_FACTOR * BASE_DETECT_RADIUS) return false;
+
+    #if M2_RESTRICT_DEFENDER_ATTACK
+        if (h->mode == M_DEFENSE) {
+            if (data.enemyInBase) {
+                if (myBaseMonsterDist > M1_INVASION_RADIUS_FACTOR * BASE_DETECT_RADIUS) return false;
+                if (data.distEnemyEntity[data.enemyInBase->rank][m->id] > CONTROL_RADIUS) return false;
+            } else {
+                if (myBaseMonsterDist > M1_DEFENSE_RADIUS_FACTOR * BASE_DETECT_RADIUS) return false;
+            }
+        }
+    #endif
+
+    // Attack near enemy base
+    if (h->mode == M_ATTACK) {
+        if (opBaseMonsterDist > M8_ATTACK_RADIUS_FACTOR * BASE_DETECT_RADIUS) return false;
+        if (opBaseMonsterDist < M8_INNER_ATTACK_RADIUS_FACTOR * BASE_DETECT_RADIUS) return false;
+    }
+
+    return true;
+}
+
+float targetEval(Entity* h, Entity* m) {
+    float heroMonsterDist = data.distHeroEntity[h->rank][m->id];
+    float myBaseMonsterDist = data.distBaseEntity[PLAYER_ME][m->id];
+    float opBaseMonsterDist = data.distBaseEntity[PLAYER_OP][m->id];
+
+    float eval = 0.0;
+    if (m->nbAttacker == 0) eval = 0.1;
+
+    if (h->mode == M_ATTACK) {
+        if (m->threatFor != MONSTER_THREAT_OP) {
+            if (m->nbAttacker < M2_ATTACK_NB_THREAT_MAX) eval += 1000.0 / opBaseMonsterDist;
+        }
+    } else {
+        if (m->threatFor == MONSTER_THREAT_ME) {
+            if (m->nbAttacker < M2_ATTACK_NB_THREAT_MAX) eval += 1000.0 / myBaseMonsterDist;
+        }
+        if (m->nearBase == MONSTER_THREAT_ME) {
+            if (m->nbAttacker < M2_ATTACK_NB_THREAT_MAX) eval += 10000.0 / myBaseMonsterDist;
+        }
+    }
+
+    if (eval > 0.0) eval = eval / ( heroMonsterDist + 1.0);
+
+    return eval;
+}
+
+/* ---------- DECISION CACHE FUNCTIONS -------------*/
+
+// Decision of previous round can be reused if its inputs did not drift
+char isDecisionValid(Decision* d, Entity* h, Point input) {
+    if (d->round != game.round - 1) return false;
+    if (d->age >= M0_CACHE_AGE_MAX) return false;
+    if (d->mode != h->mode) return false;
+    if (distance(d->hero, h->pos) > M0_CACHE_TOLERANCE) return false;
+    if (distance(d->input, input) > M0_CACHE_TOLERANCE) return false;
+
+    return true;
+}
+
+void saveDecision(Decision* d, Entity* h, int target, Point heroDest, Point input, Point result, int step, char reused) {
+    d->age = reused ? d->age + 1 : 0;
+    d->round = game.round;
+    d->mode = h->mode;
+    d->target = target;
+    d->hero = moveToward(h->pos, heroDest, HERO_SPEED);
+    d->input = input;
+    d->result = result;
+    d->step = step;
+}
+
+Point monsterCentroid(Point pos, int radius, int* nb) {
+    Point centroid = { .x = 0, .y = 0 };
+    *nb = 0;
+    for (int i = 0; i < data.nbMonster; i++) {
+        Entity* m = data.monsters[i];
+        if (!isPointInCircle(pos, radius, m->pos)) continue;
+
+        centroid.x += m->pos.x;
+        centroid.y += m->pos.y;
+        (*nb)++;
+    }
+    if (*nb > 0) {
+        centroid.x /= *nb;
+        centroid.y /= *nb;
+    }
+
+    return centroid;
+}
+
+Point moveToward(Point from, Point to, int speed) {
+    if (isPointInCircle(from, speed, to)) return to;
+    return pushPoint(from, to, speed);
+}
+
+// Mark exploration cells seen from a position, and their symmetric
+void visitFog(Point pos) {
+    for (int j = 0; j < GRID_HEIGHT; j++) {
+        int y = GAME_CENTER_Y + (j - GRID_CENTER_Y) * CELL_HEIGHT;
+        if (abs(y - pos.y) > HERO_FOG_RADIUS) continue;
+
+        for (int i = 0; i < GRID_WIDTH; i++) {
+            int x = GAME_CENTER_X + (i - GRID_CENTER_X) * CELL_WIDTH;
+            if (abs(x - pos.x) > HERO_FOG_RADIUS) continue;
+
+            Point cellCenter1 = { .x = x - CELL_WIDTH / 2, .y = y - CELL_HEIGHT / 2 };
+            Point cellCenter2 = { .x = x + CELL_WIDTH / 2, .y = y + CELL_HEIGHT / 2 };
+            if (isRectangleInCircle(pos, HERO_FOG_RADIUS, cellCenter1, cellCenter2)) {
+                grid.fog[j][i] = 0;
+                grid.fog[GRID_HEIGHT - j - 1][GRID_WIDTH - i - 1] = 0;
+            }
+        }
+    }
+}
+
+/* ---------- DEFENSE SOLVER FUNCTIONS -------------*/
+
+#define DEFENSE_ACTION_WIND                 M2_SOLVER_NB_THREAT_MAX
+
+// Find hero actions minimizing base damage over the next M2_SOLVER_DEPTH turns
+char solveBaseDefense(Player* me, Player* op) {
+    DefenseState s;
+    memset(&s, 0, sizeof(DefenseState));
+    s.mana = me->mana;
+
+    solver.base = me->basePos;
+    solver.opBase = op->basePos;
+    solver.nbNode = 0;
+
+    // Threats, sorted by distance to my base
+    char pressure = false;
+    solver.nbThreat = 0;
+    for (int i = 0; i < data.nbMonster; i++) {
+        Entity* m = data.monsters[i];
+        if (m->threatFor != MONSTER_THREAT_ME) continue;
+        float dist = data.distBaseEntity[PLAYER_ME][m->id];
+        if (dist > BASE_FOG_RADIUS) continue;
+        if (m->nearBase == MONSTER_THREAT_ME) pressure = true;
+
+        int t = solver.nbThreat;
+        if (t == M2_SOLVER_NB_THREAT_MAX) {
+            if (dist >= data.distBaseEntity[PLAYER_ME][solver.threats[t - 1]->id]) continue;
+            t--;
+        } else {
+            solver.nbThreat++;
+        }
+        while (t > 0 && data.distBaseEntity[PLAYER_ME][solver.threats[t - 1]->id] > dist) {
+            solver.threats[t] = solver.threats[t - 1];
+            t--;
+        }
+        solver.threats[t] = m;
+    }
+    if (!pressure) return false;
+
+    for (int t = 0; t < solver.nbThreat; t++) {
+        Entity* m = solver.threats[t];
+        s.monsters[t].x = m->pos.x;
+        s.monsters[t].y = m->pos.y;
+        s.health[t] = m->health;
+        s.shield[t] = m->shield;
+        solver.dest[t] = m->dest;
+    }
+
+    // Defenders, closest to my base first
+    solver.nbHero = 0;
+    for (int i = 0; i < data.nbHero; i++) {
+        Entity* h = data.heroes[i];
+        if (h->end) continue;
+        float dist = data.distBaseHero[PLAYER_ME][h->rank];
+        if (dist > M2_SOLVER_HERO_RADIUS_FACTOR * BASE_FOG_RADIUS) continue;
+
+        int k = solver.nbHero;
+        if (k == M2_SOLVER_NB_HERO_MAX) {
+            if (dist >= data.distBaseHero[PLAYER_ME][solver.heroes[k - 1]->rank]) continue;
+            k--;
+        } else {
+            solver.nbHero++;
+        }
+        while (k > 0 && data.distBaseHero[PLAYER_ME][solver.heroes[k - 1]->rank] > dist) {
+            solver.heroes[k] = solver.heroes[k - 1];
+            k--;
+        }
+        solver.heroes[k] = h;
+    }
+    if (solver.nbHero == 0) return false;
+
+    for (int k = 0; k < solver.nbHero; k++) {
+        s.heroes[k].x = solver.heroes[k]->pos.x;
+        s.heroes[k].y = solver.heroes[k]->pos.y;
+    }
+
+    char actions[M2_SOLVER_NB_HERO_MAX];
+    int cost = defenseSearch(&s, M2_SOLVER_DEPTH, INF_MAX, actions);
+    if (cost >= INF_MAX) return false;
+
+    #if DEBUG && DEBUG_METHOD_NAME
+        log("M2 solver: cost %d / %d nodes\n", cost, solver.nbNode);
+    #endif
+
+    // Play first turn
+    for (int k = 0; k < solver.nbHero; k++) {
+        Entity* h = solver.heroes[k];
+
+        if (actions[k] == DEFENSE_ACTION_WIND) {
+            Entity* pushed = NULL;
+            for (int t = 0; t < solver.nbThreat; t++) {
+                Entity* m = solver.threats[t];
+                if (!canCastSpell(me, h, m, WIND_RADIUS)) continue;
+                pushed = m;
+                break;
+            }
+            if (!pushed) continue;
+
+            castWind(me, h, pushed, op->basePos);
+            sprintf(mes[h->rank], "Push %d", pushed->id);
+            h->target = pushed->id;
+        } else {
+            int t = actions[k];
+            Entity* m = solver.threats[t];
+            Point inter = { .x = m->pos.x, .y = m->pos.y, .dist = 0 };
+            interception(&inter, m, h);
+            move(me, h, inter);
+            sprintf(mes[h->rank], "Def %d", m->id);
+            h->target = m->id;
+            m->nbAttacker++;
+        }
+        h->end = true;
+    }
+
+    return true;
+}
+
+// Minimal cost from state, or a value >= alpha if it cannot be lower than alpha
+int defenseSearch(DefenseState* s, int depth, int alpha, char* bestActions) {
+    int nbAlive = 0;
+    for (int t = 0; t < solver.nbThreat; t++) {
+        if (s->health[t] > 0) nbAlive++;
+    }
+    if (depth == 0 || nbAlive == 0 || solver.nbNode >= M2_SOLVER_NODE_MAX) {
+        if (bestActions) {
+            for (int k = 0; k < solver.nbHero; k++) bestActions[k] = 0;
+        }
+        return defenseLeafCost(s);
+    }
+    solver.nbNode++;
+
+    unsigned long long key = defenseHash(s, depth);
+    DefenseMemo* memo = &solver.memo[key & (M2_SOLVER_MEMO_SIZE - 1)];
+    if (memo->key == key && memo->depth == depth && (memo->exact || memo->cost >= alpha)) {
+        // A bound has no actions, the caller discards it anyway as it is >= alpha
+        if (bestActions && memo->exact) memcpy(bestActions, memo->actions, solver.nbHero);
+        return memo->cost;
+    }
+
+    // Candidate actions for each hero
+    int nbAction[M2_SOLVER_NB_HERO_MAX];
+    char actionList[M2_SOLVER_NB_HERO_MAX][M2_SOLVER_NB_THREAT_MAX + 1];
+    for (int k = 0; k < solver.nbHero; k++) {
+        nbAction[k] = 0;
+        char canWind = false;
+        int nearest = -1;
+        float distMin = INF_MAX;
+        for (int t = 0; t < solver.nbThreat; t++) {
+            if (s->health[t] <= 0) continue;
+            float dist = fastDistance(s->heroes[k], s->monsters[t]);
+            if (isPointInCircle(s->heroes[k], WIND_RADIUS, s->monsters[t]) && s->shield[t] <= 0) canWind = true;
+            if (dist < distMin) {
+                distMin = dist;
+                nearest = t;
+            }
+            // Threat is reachable before horizon
+            if (dist <= depth * HERO_SPEED + ATTACK_RADIUS) actionList[k][nbAction[k]++] = t;
+        }
+        if (canWind && s->mana >= SPELL_COST) actionList[k][nbAction[k]++] = DEFENSE_ACTION_WIND;
+        if (nbAction[k] == 0) actionList[k][nbAction[k]++] = nearest;
+    }
+
+    int best = INF_MAX;
+    char actions[M2_SOLVER_NB_HERO_MAX];
+    char bestJoint[M2_SOLVER_NB_HERO_MAX];
+    int index[M2_SOLVER_NB_HERO_MAX] = { 0 };
+    while (1) {
+        char nbWind = 0;
+        for (int k = 0; k < solver.nbHero; k++) {
+            actions[k] = actionList[k][index[k]];
+            if (actions[k] == DEFENSE_ACTION_WIND) nbWind++;
+        }
+
+        if (nbWind * SPELL_COST <= s->mana) {
+            DefenseState next;
+            int bound = min(alpha, best);
+            int stepCost = defenseStep(s, actions, &next);
+            if (stepCost < bound) {
+                int cost = stepCost + defenseSearch(&next, depth - 1, bound - stepCost, NULL);
+                if (cost < best) {
+                    best = cost;
+                    memcpy(bestJoint, actions, solver.nbHero);
+                }
+            }
+        }
+
+        // Next joint action
+        int k = 0;
+        while (k < solver.nbHero && ++index[k] == nbAction[k]) index[k++] = 0;
+        if (k == solver.nbHero) break;
+    }
+
+    char exact = best < alpha;
+    if (!exact) best = alpha;
+
+    memo->key = key;
+    memo->depth = depth;
+    memo->cost = best;
+    memo->exact = exact;
+    if (exact) memcpy(memo->actions, bestJoint, solver.nbHero);
+    if (bestActions && exact) memcpy(bestActions, bestJoint, solver.nbHero);
+
+    return best;
+}
+
+// Simulate one turn in the referee order: heroes move, attack, winds push,
+// monsters move. Return its cost
+int defenseStep(DefenseState* s, char* actions, DefenseState* n) {
+    *n = *s;
+    int cost = 0;
+
+    // Heroes move toward next position of their target
+    for (int k = 0; k < solver.nbHero; k++) {
+        if (actions[k] == DEFENSE_ACTION_WIND) continue;
+
+        int t = actions[k];
+        Point target = comboMonsterStep(s->monsters[t], solver.dest[t], solver.base, 0, false);
+        n->heroes[k] = moveToward(n->heroes[k], target, HERO_SPEED);
+        n->heroes[k].dist = 0;
+    }
+
+    // Attacks
+    for (int k = 0; k < solver.nbHero; k++) {
+        if (actions[k] == DEFENSE_ACTION_WIND) continue;
+
+        for (int t = 0; t < solver.nbThreat; t++) {
+            if (n->health[t] <= 0) continue;
+            if (isPointInCircle(n->heroes[k], ATTACK_RADIUS, n->monsters[t])) n->health[t] -= ATTACK_DAMAGE;
+        }
+    }
+
+    // Winds push monsters toward enemy base
+    for (int k = 0; k < solver.nbHero; k++) {
+        if (actions[k] != DEFENSE_ACTION_WIND) continue;
+
+        n->mana -= SPELL_COST;
+        cost += M2_SOLVER_SPELL_COST;
+        for (int t = 0; t < solver.nbThreat; t++) {
+            if (n->health[t] <= 0 || n->shield[t] > 0) continue;
+            if (!isPointInCircle(n->heroes[k], WIND_RADIUS, n->monsters[t])) continue;
+
+            n->monsters[t] = pushPoint(n->monsters[t], solver.opBase, WIND_PUSH_FORCE);
+        }
+    }
+
+    // Monsters move and damage base
+    for (int t = 0; t < solver.nbThreat; t++) {
+        if (n->health[t] <= 0) continue;
+
+        Point next = comboMonsterStep(n->monsters[t], solver.dest[t], solver.base, 0, false);
+        n->monsters[t].x = next.x;
+        n->monsters[t].y = next.y;
+        if (n->shield[t] > 0) n->shield[t]--;
+
+        if (isPointInCircle(solver.base, BASE_KILL_RADIUS, next)) {
+            n->health[t] = 0;
+            cost += M2_SOLVER_DAMAGE_COST;
+        }
+    }
+
+    return cost;
+}
+
+// Remaining threat at horizon
+int defenseLeafCost(DefenseState* s) {
+    int cost = 0;
+    for (int t = 0; t < solver.nbThreat; t++) {
+        if (s->health[t] <= 0) continue;
+
+        float dist = fastDistance(s->monsters[t], solver.base);
+        cost += 10 * s->health[t];
+        if (dist < BASE_DETECT_RADIUS) cost += (BASE_DETECT_RADIUS - dist) / 10;
+    }
+
+    return cost;
+}
+
+unsigned long long defenseHash(DefenseState* s, int depth) {
+    unsigned long long h = 14695981039346656037ULL ^ (game.round * 1000003ULL + depth);
+    #define DEFENSE_HASH(v) (h = (h ^ (unsigned long long)(v)) * 1099511628211ULL)
+    DEFENSE_HASH(s->mana);
+    for (int k = 0; k < solver.nbHero; k++) {
+        DEFENSE_HASH(s->heroes[k].x);
+        DEFENSE_HASH(s->heroes[k].y);
+    }
+    for (int t = 0; t < solver.nbThreat; t++) {
+        DEFENSE_HASH(s->monsters[t].x);
+        DEFENSE_HASH(s->monsters[t].y);
+        DEFENSE_HASH(s->health[t] > 0 ? s->health[t] : 0);
+        DEFENSE_HASH(s->shield[t]);
+    }
+    #undef DEFENSE_HASH
+
+    return h;
+}
+
 /* ---------- LOG FUNCTIONS -------------*/
 
 void logEntity(Entity* e) {
@@ -2130,7 +3400,11 @@ float distance2(Point p1, Point p2) {
 }
 
 char isPointInCircle(Point center, int radius, Point pos) {
-    return distance2(center, pos) <= (radius * radius);
+    #if FIXED_POINT_GEOMETRY
+        return distance2i(center, pos) <= (long long)radius * radius;
+    #else
+        return distance2(center, pos) <= (radius * radius);
+    #endif
 }
 
 char isRectangleInCircle(Point center, int radius, Point pos1, Point pos2) {
@@ -2160,4 +3434,56 @@ Point computeAnglePosition(Point p, int radius, float angle) {
     pa.y = p.y + round(y);
 
     return pa;
-}
\ No newline at end of file
+}
+
+// Squared distance, exact on 64 bits
+long long distance2i(Point p1, Point p2) {
+    long long dx = p2.x - p1.x;
+    long long dy = p2.y - p1.y;
+    return (dx * dx) + (dy * dy);
+}
+
+int distancei(Point p1, Point p2) {
+    return isqrt(distance2i(p1, p2));
+}
+
+// Floor of square root
+int isqrt(long long n) {
+    if (n <= 0) return 0;
+
+    long long r = sqrt((double)n);
+    while (r * r > n) r--;
+    while ((r + 1) * (r + 1) <= n) r++;
+
+    return r;
+}
+
+// Vector of given length from p1 toward p2, truncated like the referee
+Point normalizei(Point p1, Point p2, int length) {
+    Point v = { .x = 0, .y = 0 };
+    long long d2 = distance2i(p1, p2);
+    if (d2 == 0) return v;
+
+    double k = length / sqrt((double)d2);
+    v.x = (int)((p2.x - p1.x) * k);
+    v.y = (int)((p2.y - p1.y) * k);
+
+    return v;
+}
+
+// Move a point toward a target by a given force
+Point pushPoint(Point pos, Point to, int force) {
+    #if FIXED_POINT_GEOMETRY
+        Point v = normalizei(pos, to, force);
+        pos.x += v.x;
+        pos.y += v.y;
+    #else
+        float dist = distance(pos, to);
+        if (dist > 0.0) {
+            pos.x += force * (to.x - pos.x) / dist;
+            pos.y += force * (to.y - pos.y) / dist;
+        }
+    #endif
+
+    return pos;
+}
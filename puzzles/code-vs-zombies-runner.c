@@ -0,0 +1,357 @@
+#define _GNU_SOURCE                     // posix_openpt() and cfmakeraw()
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include <signal.h>
+#include <unistd.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+
+// Local referee for code-vs-zombies.c
+// Usage: runner <bot> [nbRandomLayouts] [seed]
+// Prints one JSON line per layout: score, turns, humans left, decision latency and turns over budget
+
+//---------------CONSTANTS-----------------
+// Game related
+#define GAME_WIDTH          16000
+#define GAME_HEIGHT         9000
+#define TURN_MAX            200
+#define TURN_BUDGET         100     // Referee answer time per turn in ms
+#define FIRST_TURN_BUDGET   1000    // Referee answer time on the first turn in ms
+#define TURN_TIMEOUT        5000    // Bot is considered dead past this in ms
+
+// Ash related
+#define ASH_SPEED           1000
+#define ASH_RADIUS          2000
+
+// Humans related
+#define NB_HUMANS_MAX       100
+#define HUMAN_VALUE         10
+
+//Zombies related
+#define NB_ZOMBIES_MAX      100
+#define ZOMBIE_SPEED        400
+
+// Scoring
+#define NB_FIB_MAX          57      // Same cap as the bot, the whole game score fits in a long long
+
+// Random layouts
+#define RANDOM_HUMANS_MAX   20
+#define RANDOM_ZOMBIES_MAX  40
+
+//---------------MACROS-----------------
+
+// Time
+#define GET_TIME (gettimeofday(&ttt, NULL))
+#define TOP_TIME (ttt.tv_sec * 1000.0 + ttt.tv_usec / 1000.0)
+struct timeval ttt;
+
+//---------------STRUCTS-----------------
+
+typedef struct point {
+    int x;
+    int y;
+} Point;
+
+typedef struct layout {
+    char name[32];
+    Point ash;
+    int nbHumans;
+    Point humans[NB_HUMANS_MAX];
+    int nbZombies;
+    Point zombies[NB_ZOMBIES_MAX];
+} Layout;
+
+typedef struct game {
+    Point ash;
+    int nbHumans;
+    int humanIds[NB_HUMANS_MAX];
+    Point humans[NB_HUMANS_MAX];
+    int nbZombies;
+    int zombieIds[NB_ZOMBIES_MAX];
+    Point zombies[NB_ZOMBIES_MAX];
+    Point next[NB_ZOMBIES_MAX];
+    long long score;
+    int turn;
+} Game;
+
+typedef struct bot {
+    pid_t pid;
+    FILE* in;       // Bot stdin
+    FILE* out;      // Bot stdout
+} Bot;
+
+//---------------FUNCTION DEFINITIONS-----------------
+
+long long distance2i(Point, Point);
+Point moveToward(Point, Point, int);
+void initGame(Game*, Layout*);
+void computeNext(Game*);
+void playTurn(Game*, Point);
+char startBot(Bot*, char*);
+void stopBot(Bot*);
+void runLayout(char*, Layout*, int);
+void randomLayout(Layout*, int);
+
+//---------------VARIABLES-----------------
+
+long long fib[NB_FIB_MAX];
+
+// Layouts modeled on the puzzle test cases
+Layout layouts[] = {
+    { "simple", { 0, 0 }, 1, { { 8250, 4500 } }, 1, { { 8250, 8999 } } },
+    { "two-zombies", { 5000, 0 }, 2, { { 950, 6000 }, { 8000, 6100 } }, 2, { { 3100, 7000 }, { 11500, 7100 } } },
+    { "two-zombies-redux", { 10999, 0 }, 2, { { 8000, 5500 }, { 4000, 5500 } }, 2, { { 1250, 5500 }, { 15999, 5500 } } },
+    { "scared-human", { 8000, 2000 }, 1, { { 8000, 4500 } }, 3, { { 2000, 1500 }, { 13900, 6500 }, { 7000, 7500 } } },
+    { "three-vs-three", { 7500, 2000 }, 3, { { 9000, 1200 }, { 400, 6000 }, { 15000, 8000 } }, 3, { { 2000, 1500 }, { 13900, 6500 }, { 7900, 5000 } } },
+    { "combo", { 500, 4500 }, 3, { { 100, 4000 }, { 130, 5000 }, { 10000, 4500 } }, 6,
+        { { 3000, 3000 }, { 3000, 6000 }, { 4500, 4500 }, { 6000, 3000 }, { 6000, 6000 }, { 12000, 4500 } } },
+};
+
+//---------------MAIN-----------------
+
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <bot> [nbRandomLayouts] [seed]\n", argv[0]);
+        return 1;
+    }
+
+    int nbRandom = argc > 2 ? atoi(argv[2]) : 0;
+    int seed = argc > 3 ? atoi(argv[3]) : 1;
+
+    // A bot killed while we write to it must not kill the runner
+    signal(SIGPIPE, SIG_IGN);
+
+    fib[0] = 1;
+    fib[1] = 2;
+    for (int i = 2; i < NB_FIB_MAX; i++) fib[i] = fib[i - 1] + fib[i - 2];
+
+    for (int i = 0; i < (int)(sizeof(layouts) / sizeof(Layout)); i++) {
+        runLayout(argv[1], &layouts[i], -1);
+    }
+
+    for (int i = 0; i < nbRandom; i++) {
+        Layout l;
+        randomLayout(&l, seed + i);
+        runLayout(argv[1], &l, seed + i);
+    }
+
+    return 0;
+}
+
+//---------------FUNCTIONS-----------------
+
+void runLayout(char* path, Layout* l, int seed) {
+    Game g;
+    initGame(&g, l);
+
+    Bot bot;
+    if (!startBot(&bot, path)) {
+        fprintf(stderr, "Cannot start %s\n", path);
+        exit(1);
+    }
+
+    double sumTime = 0.0;
+    double maxTime = 0.0;
+    int nbOverBudget = 0;
+    char error = false;
+    while (g.nbHumans > 0 && g.nbZombies > 0 && g.turn < TURN_MAX) {
+        computeNext(&g);
+
+        fprintf(bot.in, "%d %d\n%d\n", g.ash.x, g.ash.y, g.nbHumans);
+        for (int i = 0; i < g.nbHumans; i++) fprintf(bot.in, "%d %d %d\n", g.humanIds[i], g.humans[i].x, g.humans[i].y);
+        fprintf(bot.in, "%d\n", g.nbZombies);
+        for (int i = 0; i < g.nbZombies; i++) fprintf(bot.in, "%d %d %d %d %d\n", g.zombieIds[i], g.zombies[i].x, g.zombies[i].y, g.next[i].x, g.next[i].y);
+
+        GET_TIME;
+        double start = TOP_TIME;
+        fflush(bot.in);
+
+        Point dest;
+        char line[256];
+        struct pollfd answer = { .fd = fileno(bot.out), .events = POLLIN };
+        if (poll(&answer, 1, TURN_TIMEOUT) <= 0 || !fgets(line, sizeof(line), bot.out) || sscanf(line, "%d %d", &dest.x, &dest.y) != 2) {
+            error = true;
+            break;
+        }
+        GET_TIME;
+        double elapsed = TOP_TIME - start;
+        sumTime += elapsed;
+        if (elapsed > maxTime) maxTime = elapsed;
+        if (elapsed > (g.turn == 0 ? FIRST_TURN_BUDGET : TURN_BUDGET)) nbOverBudget++;
+
+        playTurn(&g, dest);
+    }
+
+    stopBot(&bot);
+
+    long long score = error || g.nbHumans == 0 ? 0 : g.score;
+    printf("{\"layout\": \"%s\", \"seed\": %d, \"score\": %lld, \"turns\": %d, \"humans\": %d, \"zombies\": %d, \"avg_ms\": %.3f, \"max_ms\": %.3f, \"over_budget\": %d, \"error\": %s}\n",
+        l->name, seed, score, g.turn, g.nbHumans, g.nbZombies, g.turn > 0 ? sumTime / g.turn : 0.0, maxTime, nbOverBudget, error ? "true" : "false");
+    fflush(stdout);
+}
+
+void initGame(Game* g, Layout* l) {
+    g->ash = l->ash;
+    g->nbHumans = l->nbHumans;
+    for (int i = 0; i < l->nbHumans; i++) {
+        g->humanIds[i] = i;
+        g->humans[i] = l->humans[i];
+    }
+    g->nbZombies = l->nbZombies;
+    for (int i = 0; i < l->nbZombies; i++) {
+        g->zombieIds[i] = i;
+        g->zombies[i] = l->zombies[i];
+    }
+    g->score = 0;
+    g->turn = 0;
+}
+
+// Zombies target the nearest human or Ash
+void computeNext(Game* g) {
+    for (int i = 0; i < g->nbZombies; i++) {
+        Point target = g->ash;
+        long long dist2Min = distance2i(g->zombies[i], g->ash);
+        for (int j = 0; j < g->nbHumans; j++) {
+            long long dist2 = distance2i(g->zombies[i], g->humans[j]);
+            if (dist2 < dist2Min) {
+                dist2Min = dist2;
+                target = g->humans[j];
+            }
+        }
+        g->next[i] = moveToward(g->zombies[i], target, ZOMBIE_SPEED);
+    }
+}
+
+// Zombies move, Ash moves, Ash kills, zombies eat
+void playTurn(Game* g, Point dest) {
+    for (int i = 0; i < g->nbZombies; i++) g->zombies[i] = g->next[i];
+
+    g->ash = moveToward(g->ash, dest, ASH_SPEED);
+
+    int nbKill = 0;
+    long long value = HUMAN_VALUE * g->nbHumans * g->nbHumans;
+    for (int i = 0; i < g->nbZombies; i++) {
+        if (distance2i(g->ash, g->zombies[i]) > (long long)ASH_RADIUS * ASH_RADIUS) continue;
+
+        g->score += value * fib[nbKill < NB_FIB_MAX ? nbKill : NB_FIB_MAX - 1];
+        nbKill++;
+
+        // Keep ids order, like the referee
+        for (int k = i; k < g->nbZombies - 1; k++) {
+            g->zombies[k] = g->zombies[k + 1];
+            g->next[k] = g->next[k + 1];
+            g->zombieIds[k] = g->zombieIds[k + 1];
+        }
+        g->nbZombies--;
+        i--;
+    }
+
+    for (int j = 0; j < g->nbHumans; j++) {
+        char eaten = false;
+        for (int i = 0; i < g->nbZombies && !eaten; i++) {
+            eaten = g->zombies[i].x == g->humans[j].x && g->zombies[i].y == g->humans[j].y;
+        }
+        if (!eaten) continue;
+
+        for (int k = j; k < g->nbHumans - 1; k++) {
+            g->humans[k] = g->humans[k + 1];
+            g->humanIds[k] = g->humanIds[k + 1];
+        }
+        g->nbHumans--;
+        j--;
+    }
+
+    g->turn++;
+}
+
+// Bot loops forever on end of input, it is killed once the game is over.
+// Bot stdout is a raw pseudo-terminal, so stdio flushes it at every line
+char startBot(Bot* b, char* path) {
+    int toBot[2];
+    if (pipe(toBot) < 0) return false;
+
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) < 0 || unlockpt(master) < 0) return false;
+    int slave = open(ptsname(master), O_RDWR | O_NOCTTY);
+    if (slave < 0) return false;
+
+    struct termios raw;
+    tcgetattr(slave, &raw);
+    cfmakeraw(&raw);
+    tcsetattr(slave, TCSANOW, &raw);
+
+    b->pid = fork();
+    if (b->pid < 0) return false;
+
+    if (b->pid == 0) {
+        dup2(toBot[0], STDIN_FILENO);
+        dup2(slave, STDOUT_FILENO);
+        close(toBot[0]);
+        close(toBot[1]);
+        close(master);
+        close(slave);
+
+        // Bot debug goes nowhere
+        freopen("/dev/null", "w", stderr);
+        execl(path, path, (char*)NULL);
+        _exit(127);
+    }
+
+    close(toBot[0]);
+    close(slave);
+    b->in = fdopen(toBot[1], "w");
+    b->out = fdopen(master, "r");
+
+    return b->in && b->out;
+}
+
+void stopBot(Bot* b) {
+    kill(b->pid, SIGKILL);
+    waitpid(b->pid, NULL, 0);
+    fclose(b->in);
+    fclose(b->out);
+}
+
+void randomLayout(Layout* l, int seed) {
+    srand(seed);
+    sprintf(l->name, "random");
+
+    l->ash.x = rand() % GAME_WIDTH;
+    l->ash.y = rand() % GAME_HEIGHT;
+    l->nbHumans = 1 + rand() % RANDOM_HUMANS_MAX;
+    for (int i = 0; i < l->nbHumans; i++) {
+        l->humans[i].x = rand() % GAME_WIDTH;
+        l->humans[i].y = rand() % GAME_HEIGHT;
+    }
+    l->nbZombies = 1 + rand() % RANDOM_ZOMBIES_MAX;
+    for (int i = 0; i < l->nbZombies; i++) {
+        l->zombies[i].x = rand() % GAME_WIDTH;
+        l->zombies[i].y = rand() % GAME_HEIGHT;
+    }
+}
+
+// Squared distance, exact on 64 bits
+long long distance2i(Point p1, Point p2) {
+    long long dx = p2.x - p1.x;
+    long long dy = p2.y - p1.y;
+    return (dx * dx) + (dy * dy);
+}
+
+// Move up to speed units toward target, truncated like the referee
+Point moveToward(Point from, Point to, int speed) {
+    long long d2 = distance2i(from, to);
+    if (d2 <= (long long)speed * speed) return to;
+
+    double k = speed / sqrt((double)d2);
+    from.x += (int)((to.x - from.x) * k);
+    from.y += (int)((to.y - from.y) * k);
+
+    return from;
+}
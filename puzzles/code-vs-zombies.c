@@ -3,6 +3,7 @@
 #include <string.h>
 #include <stdbool.h>
 #include <math.h>
+#include <sys/time.h>
 
 //---------------CONSTANTS-----------------
 // Game related
@@ -26,8 +27,38 @@
 //Targeting
 #define NB_INTERSTEP_MAX    20
 
+// Scoring
+#define HUMAN_VALUE         10
+#define NB_FIB_MAX          57      // Combo multipliers kept, the whole game score then fits in a long long:
+                                    // HUMAN_VALUE * NB_HUMANS_MAX^2 * NB_ZOMBIES_MAX * fib[56] < 2^63
+
+// Search
+#define MONTE_CARLO_SEARCH  1
+#define SEARCH_DEPTH        10      // Planned Ash moves, then Ash chases nearest zombie
+#define SEARCH_TURN_MAX     100     // Max simulated turns of a rollout
+#define SEARCH_ZOMBIE_RATIO 0.5     // Part of random moves heading to a zombie
+#define SEARCH_THREAT_RATIO 0.5     // Part of those heading to a zombie threatening a savable human
+#define SEARCH_SEED         42
+
+// Time
+#define TIME_LIMIT          85
+
 // Utils
 #define INF_MAX             999999
+#define INF_MIN             -999999
+
+// Geometry
+#define FIXED_POINT_GEOMETRY    1       // Integer distances and truncated moves, like the referee
+
+//---------------MACROS-----------------
+
+// Time
+#define GET_TIME (gettimeofday(&ttt, NULL))
+#define START_TIME (startTime = TOP_TIME)
+#define TOP_TIME (ttt.tv_sec * 1000.0 + ttt.tv_usec / 1000.0)
+#define ELAPSED_TIME (TOP_TIME - startTime)
+struct timeval ttt;
+double startTime;
 
 //---------------STRUCTS-----------------
 
@@ -46,10 +77,7 @@ typedef struct human {
 typedef struct zombie {
     int id;
     Point position;
-    Point next;
-    Point trajectory;
     float distFromAsh;
-    float distFromHumans[NB_HUMANS_MAX];
 } Zombie;
 
 typedef struct data {
@@ -60,24 +88,95 @@ typedef struct data {
     Zombie zombies[NB_ZOMBIES_MAX];
 } Data;
 
+// Zombies as structure of arrays, stepped all at once
+typedef struct swarm {
+    int nbZombies;
+    int id[NB_ZOMBIES_MAX];
+    int x[NB_ZOMBIES_MAX];
+    int y[NB_ZOMBIES_MAX];
+    int tx[NB_ZOMBIES_MAX];     // Nearest target of each zombie
+    int ty[NB_ZOMBIES_MAX];
+    int dist2[NB_ZOMBIES_MAX];  // Squared distance to target
+} Swarm;
+
+typedef struct oracle {
+    int arrival[NB_HUMANS_MAX];     // Earliest turn a zombie can stand on each human
+    int threat[NB_HUMANS_MAX];      // Id of that zombie, -1 if none
+} Oracle;
+
+typedef struct sim {
+    int turn;
+    long long score;
+    Point ash;
+    int nbHumans;
+    int hx[NB_HUMANS_MAX];
+    int hy[NB_HUMANS_MAX];
+    Swarm swarm;
+    Oracle oracle;
+} Sim;
+
+typedef struct plan {
+    int nbMove;
+    Point moves[SEARCH_DEPTH];      // Ash destinations
+    long long eval;
+} Plan;
+
 //---------------FUNCTION DEFINITIONS-----------------
 
 float distance(Point, Point);
-int intercept(Point*, Zombie*, Point);
+long long distance2i(Point, Point);
+int distancei(Point, Point);
+int isqrt(long long);
+Point normalizei(Point, Point, int);
+Point moveToward(Point, Point, int);
+int intercept(Point*, int, Point);
+
+void initSwarm(Swarm*, Data*);
+void swarmTarget(Swarm*, Point, int, int*, int*);
+void swarmMove(Swarm*);
+void swarmPredict(Swarm*, Point, int, int*, int*, int);
+void swarmRemove(Swarm*, int);
+
+void initOracle(Sim*);
+void oracleHuman(Sim*, int);
+void oracleKill(Sim*, int);
+void oracleRemoveHuman(Sim*, int);
+char isSavable(Sim*, int);
+int threatIndex(Sim*, int);
+
+void initFib();
+void initSim(Sim*, Data*);
+long long simTurn(Sim*, Point);
+char isSimOver(Sim*);
+Point randomMove(Sim*);
+Point nearestZombie(Sim*);
+long long rollout(Sim*, Plan*, int);
+void shiftPlan(Plan*);
+Point searchBestMove(Data*);
 
 //---------------VARIABLES-----------------
 
 Data data;
 Point centerPos = { GAME_CENTER_X, GAME_CENTER_Y };
 
+// Search
+long long fib[NB_FIB_MAX];
+Plan bestPlan;
+
 //---------------MAIN-----------------
 
 int main()
 {
+    srand(SEARCH_SEED);
+    initFib();
+    bestPlan.nbMove = 0;
+
     while (1) {
         Point bestMove = centerPos;
 
         scanf("%d%d", &data.ash.x, &data.ash.y);
+        GET_TIME;
+        START_TIME;
 
         scanf("%d", &data.nbHumans);
         for (int i = 0; i < data.nbHumans; i++) {
@@ -90,35 +189,31 @@ int main()
         scanf("%d", &data.nbZombies);
         for (int i = 0; i < data.nbZombies; i++) {
             Zombie* z = &data.zombies[i];
-            scanf("%d%d%d%d%d", &z->id, &z->position.x, &z->position.y, &z->next.x, &z->next.y);
+            // Next positions are predicted by the swarm
+            scanf("%d%d%d%*d%*d", &z->id, &z->position.x, &z->position.y);
 
             z->distFromAsh = distance(z->position, data.ash);
-            z->trajectory.x = z->next.x - z->position.x;
-            z->trajectory.y = z->next.y - z->position.y;
-
-            for (int i = 0; i < data.nbHumans; i++) {
-                Human* h = &data.humans[i];
-                z->distFromHumans[h->id] = distance(z->position, h->position);
-            }
         }
 
+    #if MONTE_CARLO_SEARCH
+        bestMove = searchBestMove(&data);
+    #else
+        Sim now;
+        initSim(&now, &data);
+
         Zombie* bestZombie = NULL;
         float distMin = INF_MAX;
-        for (int i = 0; i < data.nbZombies; i++) {
-            Zombie* z = &data.zombies[i];
-            for (int j = 0; j < data.nbHumans; j++) {
-                Human h = data.humans[j];
+        for (int j = 0; j < data.nbHumans; j++) {
+            Human h = data.humans[j];
 
-                float distAshZombie = z->distFromAsh;
-                float distZombieHuman = z->distFromHumans[h.id];
+            // If human cannot be reached before zombies, abandon him
+            if (!isSavable(&now, j)) continue;
 
-                float stepZombieHuman = distZombieHuman / ZOMBIE_SPEED;
-                float stepAshHuman = (h.distFromAsh - ASH_RADIUS + 1)/ ASH_SPEED;
-
-                // If human cannot be reached before zombie, abandon him
-                if (stepZombieHuman < stepAshHuman) continue;
+            for (int i = 0; i < data.nbZombies; i++) {
+                Zombie* z = &data.zombies[i];
+                float distZombieHuman = distance(z->position, h.position);
                 if (distZombieHuman < distMin) {
-                    distMin = z->distFromHumans[h.id];
+                    distMin = distZombieHuman;
                     bestZombie = z;
                 }
             }
@@ -130,10 +225,11 @@ int main()
             // Compute interception position
             if (bestZombie->distFromAsh > ASH_RADIUS) {
                 Point inter = { .x = bestZombie->position.x, .y = bestZombie->position.y, .dist = 0 };
-                int interStep = intercept(&inter, bestZombie, data.ash);
+                intercept(&inter, bestZombie - data.zombies, data.ash);
                 bestMove = inter;
             }
         }
+    #endif
 
         printf("%d %d\n", bestMove.x, bestMove.y); // Your destination coordinates
     }
@@ -143,20 +239,323 @@ int main()
 
 //---------------FUNCTIONS-----------------
 
-int intercept(Point* inter, Zombie* target, Point ash) {
-    Point next = { .x = target->position.x, .y = target->position.y };
-    for (char s = 0; s < NB_INTERSTEP_MAX; s++) {
-        next.x += target->trajectory.x;
-        next.y += target->trajectory.y;
+//---------------SIMULATION-----------------
+
+// Combo multipliers 1, 2, 3, 5, 8...
+void initFib() {
+    fib[0] = 1;
+    fib[1] = 2;
+    for (int i = 2; i < NB_FIB_MAX; i++) fib[i] = fib[i - 1] + fib[i - 2];
+}
+
+void initSim(Sim* s, Data* d) {
+    s->turn = 0;
+    s->score = 0;
+    s->ash = d->ash;
+    s->nbHumans = d->nbHumans;
+    for (int i = 0; i < d->nbHumans; i++) {
+        s->hx[i] = d->humans[i].position.x;
+        s->hy[i] = d->humans[i].position.y;
+    }
+    initSwarm(&s->swarm, d);
+    initOracle(s);
+}
+
+// Play one turn with Ash heading to dest, return points scored
+long long simTurn(Sim* s, Point dest) {
+    Swarm* sw = &s->swarm;
+
+    // Zombies move toward nearest human or Ash
+    swarmTarget(sw, s->ash, s->nbHumans, s->hx, s->hy);
+    swarmMove(sw);
+
+    s->ash = moveToward(s->ash, dest, ASH_SPEED);
+
+    // Ash kills zombies in range, with combo multipliers
+    long long points = 0;
+    int nbKill = 0;
+    int value = HUMAN_VALUE * s->nbHumans * s->nbHumans;
+    for (int i = 0; i < sw->nbZombies; i++) {
+        int dx = sw->x[i] - s->ash.x;
+        int dy = sw->y[i] - s->ash.y;
+        if (dx * dx + dy * dy > ASH_RADIUS * ASH_RADIUS) continue;
+
+        points += value * fib[nbKill < NB_FIB_MAX ? nbKill : NB_FIB_MAX - 1];
+        nbKill++;
+
+        int id = sw->id[i];
+        swarmRemove(sw, i--);
+        oracleKill(s, id);
+    }
+
+    // Remaining zombies eat humans they stand on
+    for (int j = 0; j < s->nbHumans; j++) {
+        for (int i = 0; i < sw->nbZombies; i++) {
+            if (sw->x[i] != s->hx[j] || sw->y[i] != s->hy[j]) continue;
+
+            oracleRemoveHuman(s, j--);
+            break;
+        }
+    }
+
+    s->turn++;
+    s->score += points;
+    return points;
+}
+
+char isSimOver(Sim* s) {
+    return s->nbHumans == 0 || s->swarm.nbZombies == 0;
+}
+
+// Full speed in a random direction, or toward a random zombie
+Point randomMove(Sim* s) {
+    Swarm* sw = &s->swarm;
+    if (sw->nbZombies > 0 && rand() < SEARCH_ZOMBIE_RATIO * RAND_MAX) {
+        int i = rand() % sw->nbZombies;
+
+        // Hopeless humans are not worth a detour
+        if (s->nbHumans > 0 && rand() < SEARCH_THREAT_RATIO * RAND_MAX) {
+            int j = rand() % s->nbHumans;
+            int t = isSavable(s, j) ? threatIndex(s, j) : -1;
+            if (t > -1) i = t;
+        }
+
+        Point dest = { .x = sw->x[i], .y = sw->y[i] };
+        return dest;
+    }
+
+    float angle = 2 * M_PI * rand() / RAND_MAX;
+    Point dest = {
+        .x = s->ash.x + ASH_SPEED * cos(angle),
+        .y = s->ash.y + ASH_SPEED * sin(angle)
+    };
+    dest.x = dest.x < 0 ? 0 : dest.x >= GAME_WIDTH ? GAME_WIDTH - 1 : dest.x;
+    dest.y = dest.y < 0 ? 0 : dest.y >= GAME_HEIGHT ? GAME_HEIGHT - 1 : dest.y;
+
+    return dest;
+}
+
+Point nearestZombie(Sim* s) {
+    Swarm* sw = &s->swarm;
+    Point best = s->ash;
+    int dist2Min = -1;
+    for (int i = 0; i < sw->nbZombies; i++) {
+        int dx = sw->x[i] - s->ash.x;
+        int dy = sw->y[i] - s->ash.y;
+        int dist2 = dx * dx + dy * dy;
+        if (dist2Min < 0 || dist2 < dist2Min) {
+            dist2Min = dist2;
+            best.x = sw->x[i];
+            best.y = sw->y[i];
+        }
+    }
+
+    return best;
+}
+
+// Replay first keep moves of plan, draw the others, then chase zombies until game ends
+long long rollout(Sim* s, Plan* p, int keep) {
+    int m = 0;
+    while (!isSimOver(s) && s->turn < SEARCH_TURN_MAX) {
+        Point dest;
+        if (m < keep) dest = p->moves[m];
+        else if (m < SEARCH_DEPTH) dest = randomMove(s);
+        else dest = nearestZombie(s);
+
+        if (m < SEARCH_DEPTH) p->moves[m++] = dest;
+        simTurn(s, dest);
+    }
+
+    p->nbMove = m;
+    p->eval = s->nbHumans == 0 ? -1 : s->score;
+    return p->eval;
+}
+
+void shiftPlan(Plan* p) {
+    if (p->nbMove == 0) return;
+
+    for (int m = 1; m < p->nbMove; m++) p->moves[m - 1] = p->moves[m];
+    p->nbMove--;
+}
+
+// Rolling horizon, previous best plan is shifted and challenged by mutations until time runs out
+Point searchBestMove(Data* d) {
+    Sim start;
+    initSim(&start, d);
+
+    Sim s = start;
+    shiftPlan(&bestPlan);
+    rollout(&s, &bestPlan, bestPlan.nbMove);
+
+    do {
+        Plan p = bestPlan;
+        int keep = bestPlan.eval > 0 ? rand() % (p.nbMove + 1) : 0;
 
-        if (next.x < 0 || next.y < 0) return s;
+        s = start;
+        if (rollout(&s, &p, keep) > bestPlan.eval) bestPlan = p;
 
+        GET_TIME;
+    } while (ELAPSED_TIME < TIME_LIMIT);
+
+    return bestPlan.nbMove > 0 ? bestPlan.moves[0] : nearestZombie(&start);
+}
+
+//---------------SWARM-----------------
+
+void initSwarm(Swarm* sw, Data* d) {
+    sw->nbZombies = d->nbZombies;
+    for (int i = 0; i < d->nbZombies; i++) {
+        sw->id[i] = i;
+        sw->x[i] = d->zombies[i].position.x;
+        sw->y[i] = d->zombies[i].position.y;
+    }
+}
+
+// Nearest human or Ash of each zombie, one pass over all zombies per human
+// Squared distances fit in int inside the map
+void swarmTarget(Swarm* sw, Point ash, int nbHumans, int* hx, int* hy) {
+    int n = sw->nbZombies;
+    int* x = sw->x;
+    int* y = sw->y;
+    int* tx = sw->tx;
+    int* ty = sw->ty;
+    int* dist2 = sw->dist2;
+
+    for (int i = 0; i < n; i++) {
+        tx[i] = ash.x;
+        ty[i] = ash.y;
+        dist2[i] = (ash.x - x[i]) * (ash.x - x[i]) + (ash.y - y[i]) * (ash.y - y[i]);
+    }
+
+    for (int j = 0; j < nbHumans; j++) {
+        int hxj = hx[j];
+        int hyj = hy[j];
+        for (int i = 0; i < n; i++) {
+            int d2 = (hxj - x[i]) * (hxj - x[i]) + (hyj - y[i]) * (hyj - y[i]);
+            char closer = d2 < dist2[i];
+            dist2[i] = closer ? d2 : dist2[i];
+            tx[i] = closer ? hxj : tx[i];
+            ty[i] = closer ? hyj : ty[i];
+        }
+    }
+}
+
+// Step every zombie toward the target set by swarmTarget, truncated like the referee
+void swarmMove(Swarm* sw) {
+    for (int i = 0; i < sw->nbZombies; i++) {
+        int dx = sw->tx[i] - sw->x[i];
+        int dy = sw->ty[i] - sw->y[i];
+        double k = sw->dist2[i] <= ZOMBIE_SPEED * ZOMBIE_SPEED ? 1.0 : ZOMBIE_SPEED / sqrt((double)sw->dist2[i]);
+        sw->x[i] += (int)(dx * k);
+        sw->y[i] += (int)(dy * k);
+    }
+}
+
+// Zombies positions in nbTurn turns, humans and Ash standing still
+void swarmPredict(Swarm* sw, Point ash, int nbHumans, int* hx, int* hy, int nbTurn) {
+    for (int t = 0; t < nbTurn; t++) {
+        swarmTarget(sw, ash, nbHumans, hx, hy);
+        swarmMove(sw);
+    }
+}
+
+void swarmRemove(Swarm* sw, int i) {
+    sw->nbZombies--;
+    sw->id[i] = sw->id[sw->nbZombies];
+    sw->x[i] = sw->x[sw->nbZombies];
+    sw->y[i] = sw->y[sw->nbZombies];
+    sw->tx[i] = sw->tx[sw->nbZombies];
+    sw->ty[i] = sw->ty[sw->nbZombies];
+    sw->dist2[i] = sw->dist2[sw->nbZombies];
+}
+
+//---------------ORACLE-----------------
+
+void initOracle(Sim* s) {
+    for (int j = 0; j < s->nbHumans; j++) oracleHuman(s, j);
+}
+
+// Earliest arrival of a zombie walking straight to a human
+void oracleHuman(Sim* s, int j) {
+    Swarm* sw = &s->swarm;
+    Oracle* o = &s->oracle;
+
+    int dist2Min = -1;
+    o->threat[j] = -1;
+    o->arrival[j] = INF_MAX;
+    for (int i = 0; i < sw->nbZombies; i++) {
+        int dx = sw->x[i] - s->hx[j];
+        int dy = sw->y[i] - s->hy[j];
+        int dist2 = dx * dx + dy * dy;
+        if (dist2Min < 0 || dist2 < dist2Min) {
+            dist2Min = dist2;
+            o->threat[j] = sw->id[i];
+        }
+    }
+
+    if (dist2Min >= 0) o->arrival[j] = s->turn + (int)ceil(sqrt((double)dist2Min) / ZOMBIE_SPEED);
+}
+
+// Only humans threatened by the dead zombie need a new arrival
+void oracleKill(Sim* s, int id) {
+    for (int j = 0; j < s->nbHumans; j++) {
+        if (s->oracle.threat[j] == id) oracleHuman(s, j);
+    }
+}
+
+void oracleRemoveHuman(Sim* s, int j) {
+    Oracle* o = &s->oracle;
+
+    s->nbHumans--;
+    s->hx[j] = s->hx[s->nbHumans];
+    s->hy[j] = s->hy[s->nbHumans];
+    o->arrival[j] = o->arrival[s->nbHumans];
+    o->threat[j] = o->threat[s->nbHumans];
+}
+
+// Ash gets the human in kill range before the earliest zombie arrival
+char isSavable(Sim* s, int j) {
+    Point human = { .x = s->hx[j], .y = s->hy[j] };
+    long long dist2 = distance2i(s->ash, human);
+    if (dist2 <= (long long)ASH_RADIUS * ASH_RADIUS) return true;
+
+    int nbStep = (int)ceil((sqrt((double)dist2) - ASH_RADIUS) / ASH_SPEED);
+    return s->turn + nbStep <= s->oracle.arrival[j];
+}
+
+// Swarm index of zombie threatening a human, -1 if none
+int threatIndex(Sim* s, int j) {
+    int id = s->oracle.threat[j];
+    for (int i = 0; i < s->swarm.nbZombies; i++) {
+        if (s->swarm.id[i] == id) return i;
+    }
+
+    return -1;
+}
+
+//---------------GEOMETRY-----------------
+
+// First predicted position of a zombie Ash can reach in time
+int intercept(Point* inter, int target, Point ash) {
+    Sim s;
+    initSim(&s, &data);
+
+    Point next;
+    for (char step = 0; step < NB_INTERSTEP_MAX; step++) {
+        swarmPredict(&s.swarm, ash, s.nbHumans, s.hx, s.hy, 1);
+        next.x = s.swarm.x[target];
+        next.y = s.swarm.y[target];
+
+#if FIXED_POINT_GEOMETRY
+        int nbStep = distancei(ash, next) / ASH_SPEED;
+#else
         float dist = distance(ash, next);
-        int step = dist / ASH_SPEED;
-        if (step <= s) {
+        int nbStep = dist / ASH_SPEED;
+#endif
+        if (nbStep <= step) {
             inter->x = next.x;
             inter->y = next.y;
-            return step;
+            return nbStep;
         }
     }
     return NB_INTERSTEP_MAX;
@@ -167,3 +566,49 @@ float distance(Point p1, Point p2) {
     float dy = p2.y - p1.y;
     return sqrt((dx * dx) + (dy * dy));
 }
+
+// Squared distance, exact on 64 bits
+long long distance2i(Point p1, Point p2) {
+    long long dx = p2.x - p1.x;
+    long long dy = p2.y - p1.y;
+    return (dx * dx) + (dy * dy);
+}
+
+int distancei(Point p1, Point p2) {
+    return isqrt(distance2i(p1, p2));
+}
+
+// Floor of square root
+int isqrt(long long n) {
+    if (n <= 0) return 0;
+
+    long long r = sqrt((double)n);
+    while (r * r > n) r--;
+    while ((r + 1) * (r + 1) <= n) r++;
+
+    return r;
+}
+
+// Vector of given length from p1 toward p2, truncated like the referee
+Point normalizei(Point p1, Point p2, int length) {
+    Point v = { .x = 0, .y = 0, .dist = 0 };
+    long long d2 = distance2i(p1, p2);
+    if (d2 == 0) return v;
+
+    double k = length / sqrt((double)d2);
+    v.x = (int)((p2.x - p1.x) * k);
+    v.y = (int)((p2.y - p1.y) * k);
+
+    return v;
+}
+
+// Move up to speed units toward target, reaching it if close enough
+Point moveToward(Point from, Point to, int speed) {
+    if (distance2i(from, to) <= (long long)speed * speed) return to;
+
+    Point v = normalizei(from, to, speed);
+    from.x += v.x;
+    from.y += v.y;
+
+    return from;
+}
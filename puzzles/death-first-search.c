@@ -2,9 +2,19 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/resource.h>
+#include <sys/time.h>
 
 // Utils
 #define INF_MIN 	-999999
+#define INF_MAX 	999999999
+
+// FLAGS
+#define BFS_ENGINE 	1
+#define INCREMENTAL_DISTANCES 	1	// Needs BFS_ENGINE
+#define LARGE_GRAPH 	0	// Storage sized from the header counts, for generated networks
+#define BENCHMARK 	0	// Needs LARGE_GRAPH, plays generated graphs instead of reading stdin
+#define GAME_SOLVER 	(!LARGE_GRAPH)	// Needs BFS_ENGINE
 
 // CONSTANTS
 #define NB_NODE_MIN 	2
@@ -16,117 +26,1081 @@
 #define NB_EXIT_MIN 	1
 #define NB_EXIT_MAX 	20
 
+#define NB_EDGE_MAX 	(2 * NB_LINK_MAX)
+#define NB_EDGE_WORDS 	((NB_EDGE_MAX + 63) / 64)
+
+#if BFS_ENGINE
+// Free cuts before the agent reaches a node, minus the cuts that node still needs
+#define SLACK_BASE 	2
+#else
 #define EVAL_EXIT 	100
 #define MAX_ITERATION 	5
+#endif
+
+#if BENCHMARK
+#define BENCHMARK_NB_SIZES 	2
+#define BENCHMARK_TURNS 	200
+#define BENCHMARK_EXIT_RATIO 	1000	// One gateway per this many nodes
+#define BENCHMARK_EXIT_LINKS 	8	// Extra links of each gateway
+#define BENCHMARK_SPAN 	64	// Links join nodes at most this far apart
+#define BENCHMARK_SEED 	42
+int benchmarkSizes[BENCHMARK_NB_SIZES] = {100000, 1000000};
+#endif
+
+#if GAME_SOLVER
+#define SOLVER_TIME_LIMIT 	80	// ms per turn
+#define SOLVER_DEPTH_MAX 	64	// Cutter moves
+#define SOLVER_DEPTH_PROVEN 	1000	// Depth stored with proven wins and losses
+#define SOLVER_TT_BITS 	16
+#define SOLVER_TT_SIZE 	(1 << SOLVER_TT_BITS)
+#define SOLVER_SEED 	42
+
+// Game values, for the cutter
+#define SOLVER_LOSS 	-1
+#define SOLVER_UNKNOWN 	0
+#define SOLVER_WIN 	1
+
+// Transposition table bounds
+#define BOUND_EXACT 	0
+#define BOUND_LOWER 	1
+#define BOUND_UPPER 	2
+#endif
+
+#if GAME_SOLVER || BENCHMARK
+// Time
+#define GET_TIME (gettimeofday(&ttt, NULL))
+#define START_TIME (startTime = TOP_TIME)
+#define TOP_TIME (ttt.tv_sec * 1000.0 + ttt.tv_usec / 1000.0)
+#define ELAPSED_TIME (TOP_TIME - startTime)
+struct timeval ttt;
+double startTime;
+#endif
 
 // STRUCTS
-typedef struct node
+#if GAME_SOLVER
+typedef struct
 {
-	int id;
-	char isExit;
-	int nbNeighbors;
-	struct node *neighbors[NB_NODE_MAX];
-} Node;
+	unsigned long long key;
+	short depth;
+	char value;
+	char bound;
+	int move;
+} TTEntry;
+#endif
+
+// Arrays are sized from the header counts in large graph mode
+#if LARGE_GRAPH
+#define ARRAY(type, name, size) type *name
+#else
+#define ARRAY(type, name, size) type name[size]
+#endif
 
 // VARIABLES
 int nbNodes;
 int nbLinks;
 int nbExits;
 
-Node nodes[NB_NODE_MAX];
+// Links as read, until the graph is built
+ARRAY(int, linkFrom, NB_LINK_MAX);
+ARRAY(int, linkTo, NB_LINK_MAX);
+
+// Graph in CSR form, each link is stored as two half-edges
+ARRAY(int, offsets, NB_NODE_MAX + 1);	// Half-edges of node n are offsets[n] to offsets[n + 1] - 1
+ARRAY(int, targets, NB_EDGE_MAX);
+ARRAY(int, reverse, NB_EDGE_MAX);	// Twin half-edge, on the other endpoint
+ARRAY(unsigned long long, alive, NB_EDGE_WORDS);
+ARRAY(char, isExit, NB_NODE_MAX);
+
+#if BFS_ENGINE
+ARRAY(unsigned long long, exitEdge, NB_EDGE_WORDS);	// Half-edges leading to an exit
+ARRAY(int, gatewayLinks, NB_NODE_MAX);
+ARRAY(int, parentEdge, NB_NODE_MAX);	// Shortest path tree, half-edge from the parent, -1 for roots and unreached nodes
+
+#if !INCREMENTAL_DISTANCES
+// Agent distances, counting only nodes where we get a free cut
+ARRAY(int, dist, NB_NODE_MAX);
+ARRAY(int, deque, NB_NODE_MAX);
+ARRAY(int, visited, NB_NODE_MAX);
+int nbVisited;
+#endif
+#endif
+
+#if INCREMENTAL_DISTANCES
+// Distances grown from the gateway-adjacent nodes instead of the agent, so its moves
+// change nothing: the key of a node is the least slack of a cut it leads to, scaled
+// so that more gateway links win ties, and its anchor the node to cut
+ARRAY(int, cutKey, NB_NODE_MAX);
+ARRAY(int, anchor, NB_NODE_MAX);
+int linkScale;	// Above any gateway link count
+
+// Nodes whose key is being repaired, and the min-heap re-seeding them
+ARRAY(int, dirty, NB_NODE_MAX);
+int nbDirty;
+ARRAY(int, heapKey, NB_EDGE_MAX + NB_NODE_MAX);
+ARRAY(int, heapNode, NB_EDGE_MAX + NB_NODE_MAX);
+int heapSize;
+#endif
+
+#if GAME_SOLVER
+// Zobrist keys, shared by both half-edges of a link
+unsigned long long zobristEdge[NB_EDGE_MAX];
+unsigned long long zobristAgent[NB_NODE_MAX];
+unsigned long long randomState = SOLVER_SEED;
+TTEntry transpositions[SOLVER_TT_SIZE];
+// Links cut in the real game, the table outlives the turn so keys must include them
+unsigned long long cutHash;
+
+// Gateway links alive at the root, the cuts the solver tries besides the agent's links
+int solverLinks[NB_EDGE_MAX];
+int nbSolverLinks;
+int nbLiveGatewayLinks;
+
+int reachStamp[NB_NODE_MAX];
+int reachQueue[NB_NODE_MAX];
+int currentReachStamp;
+
+int rootMove;
+long long nbSolverNodes;
+char solverAborted;
+#endif
+
+#if LARGE_GRAPH
+long long allocatedBytes;
+#endif
 
 // FUNCTIONS
-void removeNeighbor(Node *node, int id)
+#if LARGE_GRAPH
+void *allocArray(long long count, int size)
+{
+	void *array = calloc(count > 0 ? count : 1, size);
+	if (array == NULL)
+	{
+		fprintf(stderr, "Out of memory\n");
+		exit(1);
+	}
+	allocatedBytes += count * size;
+	return array;
+}
+
+// Everything is proportional to V + E, sized from the header counts
+void allocGraph()
+{
+	int nbEdges = 2 * nbLinks;
+	int nbWords = (nbEdges + 63) / 64;
+
+	allocatedBytes = 0;
+	linkFrom = allocArray(nbLinks, sizeof(int));
+	linkTo = allocArray(nbLinks, sizeof(int));
+	offsets = allocArray(nbNodes + 1, sizeof(int));
+	targets = allocArray(nbEdges, sizeof(int));
+	reverse = allocArray(nbEdges, sizeof(int));
+	alive = allocArray(nbWords, sizeof(unsigned long long));
+	isExit = allocArray(nbNodes, sizeof(char));
+#if BFS_ENGINE
+	exitEdge = allocArray(nbWords, sizeof(unsigned long long));
+	gatewayLinks = allocArray(nbNodes, sizeof(int));
+	parentEdge = allocArray(nbNodes, sizeof(int));
+#if !INCREMENTAL_DISTANCES
+	dist = allocArray(nbNodes, sizeof(int));
+	deque = allocArray(nbNodes, sizeof(int));
+	visited = allocArray(nbNodes, sizeof(int));
+#endif
+#endif
+#if INCREMENTAL_DISTANCES
+	cutKey = allocArray(nbNodes, sizeof(int));
+	anchor = allocArray(nbNodes, sizeof(int));
+	dirty = allocArray(nbNodes, sizeof(int));
+	heapKey = allocArray(nbEdges + nbNodes, sizeof(int));
+	heapNode = allocArray(nbEdges + nbNodes, sizeof(int));
+#endif
+}
+
+// The links as read are only needed until the CSR is built
+void freeLinks()
+{
+	free(linkFrom);
+	free(linkTo);
+	allocatedBytes -= 2LL * nbLinks * sizeof(int);
+	linkFrom = NULL;
+	linkTo = NULL;
+}
+
+void freeGraph()
+{
+	free(offsets);
+	free(targets);
+	free(reverse);
+	free(alive);
+	free(isExit);
+#if BFS_ENGINE
+	free(exitEdge);
+	free(gatewayLinks);
+	free(parentEdge);
+#if !INCREMENTAL_DISTANCES
+	free(dist);
+	free(deque);
+	free(visited);
+#endif
+#endif
+#if INCREMENTAL_DISTANCES
+	free(cutKey);
+	free(anchor);
+	free(dirty);
+	free(heapKey);
+	free(heapNode);
+#endif
+}
+#endif
+
+// Two passes over the links: degrees, then half-edges, offsets[n] serving as
+// the fill cursor of node n - 1 so no extra array is needed
+void buildGraph()
+{
+	memset(offsets, 0, (nbNodes + 1) * sizeof(offsets[0]));
+	for (int i = 0; i < nbLinks; i++)
+	{
+		offsets[linkFrom[i] + 1]++;
+		offsets[linkTo[i] + 1]++;
+	}
+	for (int n = 0; n < nbNodes; n++)
+		offsets[n + 1] += offsets[n];
+
+	memset(alive, 0, (2 * nbLinks + 63) / 64 * sizeof(alive[0]));
+	for (int i = 0; i < nbLinks; i++)
+	{
+		int e1 = offsets[linkFrom[i]]++;
+		int e2 = offsets[linkTo[i]]++;
+
+		targets[e1] = linkTo[i];
+		targets[e2] = linkFrom[i];
+		reverse[e1] = e2;
+		reverse[e2] = e1;
+		alive[e1 >> 6] |= 1ULL << (e1 & 63);
+		alive[e2 >> 6] |= 1ULL << (e2 & 63);
+	}
+
+	// Each offset now points at the end of its node, shift them back
+	for (int n = nbNodes; n > 0; n--)
+		offsets[n] = offsets[n - 1];
+	offsets[0] = 0;
+}
+
+// First alive half-edge in [e, end), or end, skipping dead ones a word at a time
+int nextEdge(int e, int end)
+{
+	while (e < end)
+	{
+		unsigned long long word = alive[e >> 6] >> (e & 63);
+		if (word)
+		{
+			e += __builtin_ctzll(word);
+			return e < end ? e : end;
+		}
+		e = (e | 63) + 1;
+	}
+	return end;
+}
+
+// Cut a link on both endpoints
+void cutEdge(int e)
+{
+	int r = reverse[e];
+	alive[e >> 6] &= ~(1ULL << (e & 63));
+	alive[r >> 6] &= ~(1ULL << (r & 63));
+}
+
+#if BFS_ENGINE
+void initExitEdges()
+{
+	memset(exitEdge, 0, (offsets[nbNodes] + 63) / 64 * sizeof(exitEdge[0]));
+	for (int e = 0; e < offsets[nbNodes]; e++)
+	{
+		if (isExit[targets[e]])
+			exitEdge[e >> 6] |= 1ULL << (e & 63);
+	}
+}
+
+// Alive links from node to an exit, counted a word at a time
+int countGatewayLinks(int node)
+{
+	int count = 0;
+	int end = offsets[node + 1];
+	for (int e = offsets[node]; e < end;)
+	{
+		int width = 64 - (e & 63);
+		unsigned long long word = (alive[e >> 6] & exitEdge[e >> 6]) >> (e & 63);
+		if (end - e < width)
+		{
+			width = end - e;
+			word &= (1ULL << width) - 1;
+		}
+		count += __builtin_popcountll(word);
+		e += width;
+	}
+	return count;
+}
+
+// First alive link from node to an exit, or -1
+int firstGatewayEdge(int node)
+{
+	int end = offsets[node + 1];
+	for (int e = offsets[node]; e < end;)
+	{
+		unsigned long long word = (alive[e >> 6] & exitEdge[e >> 6]) >> (e & 63);
+		if (word)
+		{
+			e += __builtin_ctzll(word);
+			return e < end ? e : -1;
+		}
+		e = (e | 63) + 1;
+	}
+	return -1;
+}
+
+#if INCREMENTAL_DISTANCES
+// Cost of entering a node, nothing if we have to cut one of its gateway links there
+int nodeCost(int node)
+{
+	return gatewayLinks[node] > 0 ? 0 : 1;
+}
+
+// Key of a gateway-adjacent node anchoring itself: its links are spent as the agent arrives
+int seedKey(int node)
+{
+	return -gatewayLinks[node] * (linkScale + 1);
+}
+
+void pushHeap(int key, int node)
+{
+	int i = heapSize++;
+	while (i > 0 && heapKey[(i - 1) / 2] > key)
+	{
+		heapKey[i] = heapKey[(i - 1) / 2];
+		heapNode[i] = heapNode[(i - 1) / 2];
+		i = (i - 1) / 2;
+	}
+	heapKey[i] = key;
+	heapNode[i] = node;
+}
+
+int popHeap()
+{
+	int node = heapNode[0];
+	int key = heapKey[--heapSize];
+	int n = heapNode[heapSize];
+
+	int i = 0;
+	while (2 * i + 1 < heapSize)
+	{
+		int child = 2 * i + 1;
+		if (child + 1 < heapSize && heapKey[child + 1] < heapKey[child])
+			child++;
+		if (heapKey[child] >= key)
+			break;
+		heapKey[i] = heapKey[child];
+		heapNode[i] = heapNode[child];
+		i = child;
+	}
+	heapKey[i] = key;
+	heapNode[i] = n;
+
+	return node;
+}
+
+// Append the tree below node to the dirty list, without touching the keys yet
+void collectSubtree(int node)
+{
+	int first = nbDirty;
+	dirty[nbDirty++] = node;
+	for (int i = first; i < nbDirty; i++)
+	{
+		int current = dirty[i];
+		int end = offsets[current + 1];
+		for (int e = nextEdge(offsets[current], end); e < end; e = nextEdge(e + 1, end))
+		{
+			if (parentEdge[targets[e]] == e)
+				dirty[nbDirty++] = targets[e];
+		}
+	}
+}
+
+// Re-seed the dirty nodes from their own gateway links and their valid neighbors,
+// then settle them with Dijkstra
+void repairDistances()
+{
+	for (int i = 0; i < nbDirty; i++)
+	{
+		cutKey[dirty[i]] = INF_MAX;
+		parentEdge[dirty[i]] = -1;
+	}
+
+	heapSize = 0;
+	for (int i = 0; i < nbDirty; i++)
+	{
+		int node = dirty[i];
+		if (gatewayLinks[node] > 0)
+		{
+			cutKey[node] = seedKey(node);
+			anchor[node] = node;
+		}
+
+		int end = offsets[node + 1];
+		for (int e = nextEdge(offsets[node], end); e < end; e = nextEdge(e + 1, end))
+		{
+			int from = targets[e];
+			if (isExit[from] || cutKey[from] == INF_MAX)
+				continue;
+
+			int key = cutKey[from] + nodeCost(node) * linkScale;
+			if (key < cutKey[node])
+			{
+				cutKey[node] = key;
+				parentEdge[node] = reverse[e];
+				anchor[node] = anchor[from];
+			}
+		}
+		if (cutKey[node] != INF_MAX)
+			pushHeap(cutKey[node], node);
+	}
+
+	while (heapSize > 0)
+	{
+		int key = heapKey[0];
+		int node = popHeap();
+		if (key > cutKey[node])
+			continue;
+
+		int end = offsets[node + 1];
+		for (int e = nextEdge(offsets[node], end); e < end; e = nextEdge(e + 1, end))
+		{
+			int next = targets[e];
+			if (isExit[next])
+				continue;
+
+			int nextKey = key + nodeCost(next) * linkScale;
+			if (nextKey < cutKey[next])
+			{
+				cutKey[next] = nextKey;
+				parentEdge[next] = e;
+				anchor[next] = anchor[node];
+				pushHeap(nextKey, next);
+			}
+		}
+	}
+	nbDirty = 0;
+}
+
+// One Dijkstra from every gateway-adjacent node at once
+void initDistances()
 {
-	int index = NB_NODE_MAX;
-	for (int i = 0; i < node->nbNeighbors - 1; i++)
+	linkScale = 1;
+	nbDirty = 0;
+	for (int n = 0; n < nbNodes; n++)
 	{
-		if (node->neighbors[i]->id == id)
-			index = i;
-		if (index <= i)
-			node->neighbors[i] = node->neighbors[i + 1];
+		parentEdge[n] = -1;
+		gatewayLinks[n] = isExit[n] ? 0 : countGatewayLinks(n);
+		if (gatewayLinks[n] >= linkScale)
+			linkScale = gatewayLinks[n] + 1;
+		if (!isExit[n])
+			dirty[nbDirty++] = n;
 	}
-	node->nbNeighbors--;
+
+	repairDistances();
 }
 
-int evalNode(Node *node, int depth)
+// Cut a link and repair the keys it worsened, the agent's moves never need any
+void cutLink(int e)
+{
+	int from = targets[reverse[e]];
+	int to = targets[e];
+	cutEdge(e);
+
+	nbDirty = 0;
+	if (isExit[from] != isExit[to])
+	{
+		// The gateway-adjacent end anchors a weaker cut, or costs a step to cross
+		int node = isExit[from] ? to : from;
+		gatewayLinks[node]--;
+		collectSubtree(node);
+	}
+	else if (parentEdge[to] == e)
+		collectSubtree(to);
+	else if (parentEdge[from] == reverse[e])
+		collectSubtree(from);
+
+	if (nbDirty > 0)
+		repairDistances();
+}
+#else
+// 0-1 BFS from the agent: entering a gateway-adjacent node costs nothing,
+// since we have to spend the cut made there on one of its gateway links
+void computeDistances(int agent)
+{
+	for (int n = 0; n < nbNodes; n++)
+	{
+		dist[n] = INF_MAX;
+		parentEdge[n] = -1;
+	}
+
+	int head = 0;
+	int size = 1;
+	deque[0] = agent;
+	dist[agent] = 0;
+	gatewayLinks[agent] = countGatewayLinks(agent);
+	nbVisited = 0;
+	visited[nbVisited++] = agent;
+
+	while (size > 0)
+	{
+		int node = deque[head];
+		if (++head == nbNodes)
+			head = 0;
+		size--;
+
+		int end = offsets[node + 1];
+		for (int e = nextEdge(offsets[node], end); e < end; e = nextEdge(e + 1, end))
+		{
+			int next = targets[e];
+			if (isExit[next] || dist[next] != INF_MAX)
+				continue;
+
+			// Nodes are popped by increasing distance and the cost only depends on the
+			// node entered, so the first discovery is final
+			gatewayLinks[next] = countGatewayLinks(next);
+			visited[nbVisited++] = next;
+			parentEdge[next] = e;
+			if (gatewayLinks[next] > 0)
+			{
+				dist[next] = dist[node];
+				if (--head < 0)
+					head = nbNodes - 1;
+				deque[head] = next;
+			}
+			else
+			{
+				dist[next] = dist[node] + 1;
+				int tail = head + size;
+				deque[tail < nbNodes ? tail : tail - nbNodes] = next;
+			}
+			size++;
+		}
+	}
+}
+
+// Least slack first, then more gateway links, then closer
+char isBetterCut(int node, int slack, int bestNode, int bestSlack)
+{
+	if (slack != bestSlack)
+		return slack < bestSlack;
+	if (gatewayLinks[node] != gatewayLinks[bestNode])
+		return gatewayLinks[node] > gatewayLinks[bestNode];
+	return dist[node] < dist[bestNode];
+}
+#endif
+
+// Any alive link, preferably around the agent
+int anyEdge(int agent)
+{
+	int e = nextEdge(offsets[agent], offsets[agent + 1]);
+	if (e < offsets[agent + 1])
+		return e;
+	return nextEdge(0, offsets[nbNodes]);
+}
+
+int bestCut(int agent)
+{
+	// Urgent, the agent is next to an exit
+	int e = firstGatewayEdge(agent);
+	if (e != -1)
+		return e;
+
+	// Gateway-adjacent node the agent reaches with the least slack, multi-gateway first
+#if INCREMENTAL_DISTANCES
+	// The key is (slack - SLACK_BASE) * linkScale - links, so it orders like isBetterCut:
+	// equal slack and links mean equal distance, where "closer" never broke a tie
+	int bestNode = cutKey[agent] != INF_MAX ? anchor[agent] : -1;
+#else
+	int bestNode = -1;
+	int bestSlack = INF_MAX;
+	computeDistances(agent);
+
+	for (int i = 0; i < nbVisited; i++)
+	{
+		int node = visited[i];
+		if (gatewayLinks[node] == 0)
+			continue;
+
+		int slack = dist[node] - gatewayLinks[node] + SLACK_BASE;
+		if (isBetterCut(node, slack, bestNode, bestSlack))
+		{
+			bestSlack = slack;
+			bestNode = node;
+		}
+	}
+#endif
+
+	if (bestNode == -1)
+		return anyEdge(agent);
+	return firstGatewayEdge(bestNode);
+}
+
+#if GAME_SOLVER
+// splitmix64
+unsigned long long nextRandom()
+{
+	unsigned long long z = (randomState += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+void initSolver()
+{
+	for (int e = 0; e < offsets[nbNodes]; e++)
+	{
+		if (e < reverse[e])
+		{
+			zobristEdge[e] = nextRandom();
+			zobristEdge[reverse[e]] = zobristEdge[e];
+		}
+	}
+	for (int n = 0; n < nbNodes; n++)
+	{
+		zobristAgent[n] = nextRandom();
+		reachStamp[n] = 0;
+	}
+	currentReachStamp = 0;
+	memset(transpositions, 0, sizeof(transpositions));
+}
+
+void restoreEdge(int e)
+{
+	int r = reverse[e];
+	alive[e >> 6] |= 1ULL << (e & 63);
+	alive[r >> 6] |= 1ULL << (r & 63);
+}
+
+char isGatewayEdge(int e)
+{
+	return exitEdge[e >> 6] >> (e & 63) & 1;
+}
+
+// Can the agent still reach a gateway at all
+char canReachGateway(int agent)
+{
+	currentReachStamp++;
+	int size = 0;
+	reachQueue[size++] = agent;
+	reachStamp[agent] = currentReachStamp;
+	for (int i = 0; i < size; i++)
+	{
+		int node = reachQueue[i];
+		if (firstGatewayEdge(node) != -1)
+			return true;
+
+		int end = offsets[node + 1];
+		for (int e = nextEdge(offsets[node], end); e < end; e = nextEdge(e + 1, end))
+		{
+			int next = targets[e];
+			if (!isExit[next] && reachStamp[next] != currentReachStamp)
+			{
+				reachStamp[next] = currentReachStamp;
+				reachQueue[size++] = next;
+			}
+		}
+	}
+	return false;
+}
+
+int solveCutter(int agent, int depth, int ply, int alpha, int beta, unsigned long long linkHash);
+
+// Agent to move after a cut, it picks the worst reply for us
+int solveAgent(int agent, int depth, int ply, int alpha, int beta, unsigned long long linkHash)
+{
+	if (firstGatewayEdge(agent) != -1)
+		return SOLVER_LOSS;
+
+	int value = SOLVER_WIN;
+	int end = offsets[agent + 1];
+	for (int e = nextEdge(offsets[agent], end); e < end; e = nextEdge(e + 1, end))
+	{
+		int v = solveCutter(targets[e], depth - 1, ply + 1, alpha, value < beta ? value : beta, linkHash);
+		if (solverAborted)
+			return SOLVER_UNKNOWN;
+		if (v < value)
+			value = v;
+		if (value <= alpha)
+			break;
+	}
+	return value;
+}
+
+int solveCut(int e, int agent, int depth, int ply, int alpha, int beta, unsigned long long linkHash)
+{
+	char gateway = isGatewayEdge(e) || isGatewayEdge(reverse[e]);
+	cutEdge(e);
+	nbLiveGatewayLinks -= gateway;
+
+	int v = solveAgent(agent, depth, ply, alpha, beta, linkHash ^ zobristEdge[e]);
+
+	nbLiveGatewayLinks += gateway;
+	restoreEdge(e);
+	return v;
+}
+
+// Cutter to move, alpha-beta over win / unknown / loss
+int solveCutter(int agent, int depth, int ply, int alpha, int beta, unsigned long long linkHash)
+{
+	if (nbLiveGatewayLinks == 0)
+		return SOLVER_WIN;
+	if (depth == 0)
+		return canReachGateway(agent) ? SOLVER_UNKNOWN : SOLVER_WIN;
+
+	if ((++nbSolverNodes & 63) == 0)
+	{
+		GET_TIME;
+		if (ELAPSED_TIME > SOLVER_TIME_LIMIT)
+			solverAborted = true;
+	}
+	if (solverAborted)
+		return SOLVER_UNKNOWN;
+
+	unsigned long long key = linkHash ^ zobristAgent[agent];
+	TTEntry *entry = &transpositions[key & (SOLVER_TT_SIZE - 1)];
+	int ttMove = -1;
+	if (entry->key == key)
+	{
+		ttMove = entry->move;
+		if (entry->depth >= depth && ply > 0)
+		{
+			if (entry->bound == BOUND_EXACT
+				|| (entry->bound == BOUND_LOWER && entry->value >= beta)
+				|| (entry->bound == BOUND_UPPER && entry->value <= alpha))
+				return entry->value;
+		}
+	}
+
+	int alphaStart = alpha;
+	int value = SOLVER_LOSS - 1;
+	int bestMove = -1;
+
+	// The agent is next to a gateway, any other cut loses
+	int urgent = firstGatewayEdge(agent);
+	if (urgent != -1)
+	{
+		value = solveCut(urgent, agent, depth, ply, alpha, beta, linkHash);
+		bestMove = urgent;
+	}
+	else
+	{
+		// Transposition move first, then gateway links, then the agent's own links
+		int nbMoves = 0;
+		int moves[NB_EDGE_MAX + NB_NODE_MAX];
+		if (ttMove != -1 && nextEdge(ttMove, ttMove + 1) == ttMove)
+			moves[nbMoves++] = ttMove;
+		for (int i = 0; i < nbSolverLinks; i++)
+		{
+			int e = solverLinks[i];
+			if (e != ttMove && nextEdge(e, e + 1) == e)
+				moves[nbMoves++] = e;
+		}
+		int end = offsets[agent + 1];
+		for (int e = nextEdge(offsets[agent], end); e < end; e = nextEdge(e + 1, end))
+		{
+			if (e != ttMove)
+				moves[nbMoves++] = e;
+		}
+
+		for (int i = 0; i < nbMoves; i++)
+		{
+			int v = solveCut(moves[i], agent, depth, ply, alpha, beta, linkHash);
+			if (solverAborted)
+				return SOLVER_UNKNOWN;
+			if (v > value)
+			{
+				value = v;
+				bestMove = moves[i];
+			}
+			if (value > alpha)
+				alpha = value;
+			if (alpha >= beta)
+				break;
+		}
+	}
+	if (solverAborted)
+		return SOLVER_UNKNOWN;
+
+	if (ply == 0)
+		rootMove = bestMove;
+
+	entry->key = key;
+	entry->value = value;
+	entry->move = bestMove;
+	entry->bound = value <= alphaStart ? BOUND_UPPER : value >= beta ? BOUND_LOWER : BOUND_EXACT;
+	char proven = (value == SOLVER_WIN && entry->bound != BOUND_UPPER)
+		|| (value == SOLVER_LOSS && entry->bound != BOUND_LOWER);
+	entry->depth = proven ? SOLVER_DEPTH_PROVEN : depth;
+
+	return value;
+}
+
+// Iterative deepening until the game is proven or the time is up,
+// returns the winning cut or -1 to fall back on the heuristic
+int solveTurn(int agent)
+{
+	nbSolverLinks = 0;
+	for (int e = nextEdge(0, offsets[nbNodes]); e < offsets[nbNodes]; e = nextEdge(e + 1, offsets[nbNodes]))
+	{
+		if (isGatewayEdge(e))
+			solverLinks[nbSolverLinks++] = e;
+	}
+	nbLiveGatewayLinks = nbSolverLinks;
+
+	nbSolverNodes = 0;
+	solverAborted = false;
+	int value = SOLVER_UNKNOWN;
+	int move = -1;
+	for (int depth = 1; depth <= SOLVER_DEPTH_MAX && depth <= nbSolverLinks + 1; depth++)
+	{
+		int v = solveCutter(agent, depth, 0, SOLVER_LOSS, SOLVER_WIN, cutHash);
+		if (solverAborted)
+			break;
+
+		value = v;
+		move = rootMove;
+		if (value != SOLVER_UNKNOWN)
+			break;
+	}
+
+	return value == SOLVER_WIN ? move : -1;
+}
+#endif
+#else
+int evalNode(int node, int depth)
 {
 	if (depth == MAX_ITERATION)
 		return INF_MIN;
-	if (node->isExit)
+	if (isExit[node])
 		return EVAL_EXIT / depth;
 
 	float bestEval = INF_MIN;
-	for (int i = 0; i < node->nbNeighbors; i++)
+	int end = offsets[node + 1];
+	for (int e = nextEdge(offsets[node], end); e < end; e = nextEdge(e + 1, end))
 	{
-		Node *neighbor = node->neighbors[i];
-		float eval = evalNode(neighbor, depth + 1);
+		float eval = evalNode(targets[e], depth + 1);
 		if (eval > bestEval)
 			bestEval = eval;
 	}
 
 	return bestEval / depth;
 }
+#endif
 
-// MAIN
-int main()
+#if BENCHMARK
+// Agent's move, first step of a shortest path to the closest gateway, or -1 if none is reachable
+int stepAgent(int agent, int *previous, int *queue)
 {
-	scanf("%d%d%d", &nbNodes, &nbLinks, &nbExits);
+	for (int n = 0; n < nbNodes; n++)
+		previous[n] = -1;
 
-	for (int i = 0; i < nbNodes; i++)
+	int size = 0;
+	queue[size++] = agent;
+	previous[agent] = agent;
+	for (int i = 0; i < size; i++)
 	{
-		Node *n = &nodes[i];
-		n->id = i;
-		n->nbNeighbors = 0;
-		n->isExit = false;
+		int node = queue[i];
+		int end = offsets[node + 1];
+		for (int e = nextEdge(offsets[node], end); e < end; e = nextEdge(e + 1, end))
+		{
+			int next = targets[e];
+			if (previous[next] != -1)
+				continue;
+
+			previous[next] = node;
+			if (isExit[next])
+			{
+				while (previous[next] != agent)
+					next = previous[next];
+				return next;
+			}
+			queue[size++] = next;
+		}
 	}
+	return -1;
+}
 
-	for (int i = 0; i < nbLinks; i++)
+// Connected random graph with local links, and gateways hooked to their neighborhood
+void generateGraph(int size)
+{
+	nbNodes = size;
+	nbExits = size / BENCHMARK_EXIT_RATIO;
+	nbLinks = 2 * (size - 1) + nbExits * BENCHMARK_EXIT_LINKS;
+	allocGraph();
+
+	int i = 0;
+	for (int n = 1; n < size; n++)
+	{
+		int span = n < BENCHMARK_SPAN ? n : BENCHMARK_SPAN;
+		linkFrom[i] = n - 1 - rand() % span;
+		linkTo[i++] = n;
+		linkFrom[i] = n;
+		linkTo[i++] = (n + 1 + rand() % BENCHMARK_SPAN) % size;
+	}
+
+	// The agent starts on node 0, gateways are kept out of its neighborhood
+	for (int x = 0; x < nbExits; x++)
+	{
+		int exit = BENCHMARK_SPAN + rand() % (size - 2 * BENCHMARK_SPAN);
+		isExit[exit] = true;
+		for (int k = 0; k < BENCHMARK_EXIT_LINKS; k++)
+		{
+			linkFrom[i] = exit;
+			linkTo[i++] = exit + 1 + rand() % BENCHMARK_SPAN;
+		}
+	}
+}
+
+void runBenchmark(int size)
+{
+	generateGraph(size);
+	buildGraph();
+	freeLinks();
+	initExitEdges();
+
+	int *previous = malloc(nbNodes * sizeof(int));
+	int *queue = malloc(nbNodes * sizeof(int));
+
+	int agent = 0;
+	int nbTurns = 0;
+	double firstTime = 0;
+	double totalTime = 0;
+	double maxTime = 0;
+	const char *result = "win";
+	while (nbTurns < BENCHMARK_TURNS)
 	{
-		int N1;
-		int N2;
-		scanf("%d%d", &N1, &N2);
+		GET_TIME;
+		START_TIME;
+#if INCREMENTAL_DISTANCES
+		if (nbTurns == 0)
+			initDistances();
+		cutLink(bestCut(agent));
+#else
+		cutEdge(bestCut(agent));
+#endif
+		GET_TIME;
 
-		Node *n1 = &nodes[N1];
-		Node *n2 = &nodes[N2];
+		double elapsed = ELAPSED_TIME;
+		if (nbTurns == 0)
+			firstTime = elapsed;
+		else
+		{
+			totalTime += elapsed;
+			if (elapsed > maxTime)
+				maxTime = elapsed;
+		}
+		nbTurns++;
 
-		n1->neighbors[n1->nbNeighbors++] = n2;
-		n2->neighbors[n2->nbNeighbors++] = n1;
+		agent = stepAgent(agent, previous, queue);
+		if (agent == -1)
+			break;
+		if (isExit[agent])
+		{
+			result = "lose";
+			break;
+		}
 	}
 
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	printf("nodes %d links %d exits %d memory %.1f MB peak rss %.1f MB turns %d first %.3f ms avg %.3f ms max %.3f ms %s\n",
+		nbNodes, nbLinks, nbExits, allocatedBytes / 1048576.0, usage.ru_maxrss / 1024.0,
+		nbTurns, firstTime, nbTurns > 1 ? totalTime / (nbTurns - 1) : 0, maxTime, result);
+
+	free(previous);
+	free(queue);
+	freeGraph();
+}
+#endif
+
+// MAIN
+int main()
+{
+#if BENCHMARK
+	srand(BENCHMARK_SEED);
+	for (int i = 0; i < BENCHMARK_NB_SIZES; i++)
+		runBenchmark(benchmarkSizes[i]);
+	return 0;
+#endif
+
+	scanf("%d%d%d", &nbNodes, &nbLinks, &nbExits);
+#if LARGE_GRAPH
+	allocGraph();
+#endif
+
+	for (int i = 0; i < nbLinks; i++)
+		scanf("%d%d", &linkFrom[i], &linkTo[i]);
+
+	memset(isExit, false, nbNodes * sizeof(isExit[0]));
 	for (int i = 0; i < nbExits; i++)
 	{
 		int EI;
 		scanf("%d", &EI);
 
-		nodes[EI].isExit = true;
+		isExit[EI] = true;
 	}
 
+	buildGraph();
+#if LARGE_GRAPH
+	freeLinks();
+#endif
+#if BFS_ENGINE
+	initExitEdges();
+#endif
+#if INCREMENTAL_DISTANCES
+	initDistances();
+#endif
+#if GAME_SOLVER
+	initSolver();
+#endif
+
 	while (1)
 	{
 		int bobnetNodeId;
 		scanf("%d", &bobnetNodeId);
 
-		Node *bobnetNode = &nodes[bobnetNodeId];
-
+#if GAME_SOLVER
+		GET_TIME;
+		START_TIME;
+		int bestEdge = solveTurn(bobnetNodeId);
+		if (bestEdge == -1)
+			bestEdge = bestCut(bobnetNodeId);
+#elif BFS_ENGINE
+		int bestEdge = bestCut(bobnetNodeId);
+#else
 		float bestEval = INF_MIN;
-		Node *bestNode = NULL;
-		for (int i = 0; i < bobnetNode->nbNeighbors; i++)
+		int bestEdge = -1;
+		int end = offsets[bobnetNodeId + 1];
+		for (int e = nextEdge(offsets[bobnetNodeId], end); e < end; e = nextEdge(e + 1, end))
 		{
-			Node *node = bobnetNode->neighbors[i];
-			float eval = evalNode(node, 1);
-
+			float eval = evalNode(targets[e], 1);
 			if (eval > bestEval)
 			{
 				bestEval = eval;
-				bestNode = node;
+				bestEdge = e;
 			}
 		}
+#endif
 
-		printf("%d %d\n", bobnetNode->id, bestNode->id);
-		removeNeighbor(bobnetNode, bestNode->id);
-		removeNeighbor(bestNode, bobnetNode->id);
+		printf("%d %d\n", targets[reverse[bestEdge]], targets[bestEdge]);
+#if INCREMENTAL_DISTANCES
+		cutLink(bestEdge);
+#else
+		cutEdge(bestEdge);
+#endif
+#if GAME_SOLVER
+		cutHash ^= zobristEdge[bestEdge];
+#endif
 	}
 
 	return 0;
-}
\ No newline at end of file
+}
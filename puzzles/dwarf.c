@@ -2,86 +2,993 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdbool.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
 
 // MACROS
 #define max(a,b) ((a) > (b) ? (a) : (b))
+#define min(a,b) ((a) < (b) ? (a) : (b))
 
 // Utils
 #define INF_MIN                             -999999
 #define INF_MAX                             999999
 
+// FLAGS
+#define TOPOLOGICAL_DP                      1       // Longest chain in O(V + E), instead of exploring every path
+#define HASHED_IDS                          1       // Any 64-bit ids, mapped to dense indices, input parsed from one buffer
+#define CONDENSE_CYCLES                     1       // Needs TOPOLOGICAL_DP, each cycle counts as one node weighing its size
+#define QUERY_SERVER                        0       // Needs HASHED_IDS and TOPOLOGICAL_DP, answers the queries following the relationships
+#define ONLINE                              0       // Needs HASHED_IDS, "x y" lines add influences and "?" prints the longest chain
+#define PARALLEL                            0       // Level-synchronous Kahn over a thread pool, needs TOPOLOGICAL_DP
+#define BENCHMARK                           0       // Needs PARALLEL, times a generated DAG over 1 to NB_THREADS threads
+
 // CONSTANTS
-#define NB_PEOPLE_MAX                       10000
+#define INPUT_BUFFER                        (1 << 20)   // Initial size of the stdin buffer when it can't be mapped
+#define GROWABLE_MIN                        16      // First capacity of growable arrays
+
+#define NB_THREADS                          4
+#define LEVEL_CHUNK                         1024    // People a thread takes from the current level at once
+#define READY_BUFFER                        256     // People a thread makes ready before publishing them
+
+#define CYCLE_REPORT_MAX                    10      // People listed per cycle on stderr
+#define QUERY_WORD                          16      // Buffer for a query command
+
+#define BENCHMARK_NB_PERSONS                1000000
+#define BENCHMARK_NB_RELATIONSHIPS          10000000
+#define BENCHMARK_SPAN                      2000    // Influenced people are at most this far after their influencer
+#define BENCHMARK_SEED                      42
+
+// Time
+#define GET_TIME (gettimeofday(&ttt, NULL))
+#define START_TIME (startTime = TOP_TIME)
+#define TOP_TIME (ttt.tv_sec * 1000.0 + ttt.tv_usec / 1000.0)
+#define ELAPSED_TIME (TOP_TIME - startTime)
+struct timeval ttt;
+double startTime;
+
+// STRUCTS
+#if ONLINE
+typedef struct onlinePerson {
+    int firstInfluence;                             // -1 when p influences nobody yet
+    int depth;                                      // People in the longest chain ending with p
+} OnlinePerson;
+
+typedef struct influence {
+    int target;
+    int next;                                       // Next influence of the same influencer, -1 at the end
+} Influence;
 
-typedef struct person {
-    int id;
-    int nbInfluenced;
-    int nbInfluencedBy;
-    struct person* influenced[NB_PEOPLE_MAX];
-    struct person* influencedBy[NB_PEOPLE_MAX];
-} Person;
+// Previous depth of a person raised by the insertion in progress
+typedef struct undo {
+    int person;
+    int depth;
+} Undo;
+#endif
+
+#if PARALLEL
+// One direction of the level-synchronous pass, shared by all threads
+typedef struct levelPass {
+    int* start;
+    int* adjacency;
+    int* reverseStart;
+    int* reverseAdjacency;
+    atomic_int* degree;                             // Remaining unprocessed predecessors
+    int* order;                                     // Levels one after the other
+    int* depth;
+    atomic_int next;                                // Next index of the current level to process
+    atomic_int nbOrdered;
+    int levelStart;
+    int levelEnd;
+    pthread_barrier_t barrier;
+} LevelPass;
+#endif
 
 // VARIABLES
 int nbRelationship;                                 // the number of relationships of influence
-int lastPerson;
-int firstPerson;
-Person persons[NB_PEOPLE_MAX];
+int nbPersons;                                      // Dense indices go from 0 to nbPersons - 1
+int nbNodes;                                        // Nodes of the graph, people or condensed cycles
+
+#if HASHED_IDS
+// Whole input, mapped or read at once
+char* input;
+size_t inputSize;
+size_t inputPosition;
+
+// Open addressing from ids to dense indices, -1 for an empty slot
+long long* mapKey;
+int* mapIndex;
+unsigned long long mapMask;
+long long* ids;                                     // Id of each dense index
+int idsCapacity;
+#else
+int lastPerson;                                     // ids go from 0 to lastPerson
+#endif
+
+// Relationships as read, until the adjacency is built
+int* relationFrom;
+int* relationTo;
+
+// Adjacency in CSR form, nodes influenced by p are influenced[influencedStart[p]] to influenced[influencedStart[p + 1] - 1]
+int* influencedStart;
+int* influenced;
+int* influencedByStart;
+int* influencedBy;
+
+#if TOPOLOGICAL_DP
+int* order;                                         // Topological order, doubles as the queue of Kahn's algorithm
+int nbOrdered;
+int* depthTo;                                       // People in the longest chain ending with node p
+int* depthFrom;                                     // People in the longest chain starting with node p
+#endif
+
+#if CONDENSE_CYCLES
+int* component;                                     // Node of each person
+int* weight;                                        // People in each node
+#define NODE_WEIGHT(p) (weight[p])
+#define NODE_OF(p) (component[p])
+#else
+#define NODE_WEIGHT(p) 1
+#define NODE_OF(p) (p)
+#endif
+
+#if QUERY_SERVER
+int* ranked;                                        // People by decreasing longest chain through them
+#endif
+
+#if ONLINE
+// Growable pool of influences, chained per influencer
+OnlinePerson* onlinePersons;
+int personCapacity;
+Influence* influences;
+int nbInfluences;
+int influenceCapacity;
+
+// Undo log to roll back an influence closing a cycle
+Undo* undoLog;
+int nbUndo;
+int undoCapacity;
+int* raised;                                        // Stack of people whose raise must be propagated
+int raisedCapacity;
+
+int onlineMaxChain;
+#endif
 
 //FUNCTIONS
-int nbChainFromPerson(Person* person, int depth) {
+void* allocate(size_t size) {
+    void* p = malloc(size > 0 ? size : 1);
+    if (p == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+
+    return p;
+}
+
+// Double capacity until it holds needed elements, reallocating the array if it changed
+void* reserve(void* array, int* capacity, int needed, size_t size) {
+    if (needed <= *capacity) return array;
+
+    while (*capacity < needed) {
+        *capacity = *capacity > 0 ? 2 * *capacity : GROWABLE_MIN;
+    }
+    array = realloc(array, (size_t)*capacity * size);
+    if (array == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+
+    return array;
+}
+
+// Two passes: count degrees and prefix-sum them, then fill. start[n] serves as
+// the fill cursor of n - 1 and is shifted back at the end
+void buildAdjacency(int* from, int* to, int* start, int* adjacency) {
+    memset(start, 0, (nbNodes + 1) * sizeof(int));
+    for (int i = 0; i < nbRelationship; i++) {
+        start[from[i] + 1]++;
+    }
+    for (int p = 0; p < nbNodes; p++) {
+        start[p + 1] += start[p];
+    }
+
+    for (int i = 0; i < nbRelationship; i++) {
+        adjacency[start[from[i]]++] = to[i];
+    }
+    for (int p = nbNodes; p > 0; p--) {
+        start[p] = start[p - 1];
+    }
+    start[0] = 0;
+}
+
+void buildGraph() {
+    influencedStart = allocate((nbNodes + 1) * sizeof(int));
+    influenced = allocate(nbRelationship * sizeof(int));
+    influencedByStart = allocate((nbNodes + 1) * sizeof(int));
+    influencedBy = allocate(nbRelationship * sizeof(int));
+
+    buildAdjacency(relationFrom, relationTo, influencedStart, influenced);
+    buildAdjacency(relationTo, relationFrom, influencedByStart, influencedBy);
+
+    free(relationFrom);
+    free(relationTo);
+}
+
+#if HASHED_IDS
+// Map stdin when it is a file, otherwise read it all into a growing buffer
+void loadInput() {
+    struct stat st;
+    if (fstat(0, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        input = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, 0, 0);
+        if (input != MAP_FAILED) {
+            madvise(input, st.st_size, MADV_SEQUENTIAL);
+            inputSize = st.st_size;
+            return;
+        }
+    }
+
+    size_t capacity = INPUT_BUFFER;
+    input = allocate(capacity);
+    inputSize = 0;
+    size_t nbRead;
+    while ((nbRead = fread(input + inputSize, 1, capacity - inputSize, stdin)) > 0) {
+        inputSize += nbRead;
+        if (inputSize == capacity) {
+            capacity *= 2;
+            input = realloc(input, capacity);
+            if (input == NULL) {
+                fprintf(stderr, "Out of memory\n");
+                exit(1);
+            }
+        }
+    }
+}
+
+// Next integer of the input, false at the end
+bool readNumber(long long* value) {
+    while (inputPosition < inputSize && input[inputPosition] != '-'
+        && (input[inputPosition] < '0' || input[inputPosition] > '9')) {
+        inputPosition++;
+    }
+    if (inputPosition == inputSize) return false;
+
+    bool negative = input[inputPosition] == '-';
+    if (negative) inputPosition++;
+
+    unsigned long long number = 0;
+    while (inputPosition < inputSize && input[inputPosition] >= '0' && input[inputPosition] <= '9') {
+        number = number * 10 + (input[inputPosition++] - '0');
+    }
+    *value = negative ? (long long)(0ULL - number) : (long long)number;
+
+    return true;
+}
+
+#if QUERY_SERVER
+// Next word of the input, cut to size - 1 characters, false at the end
+bool readWord(char* word, int size) {
+    while (inputPosition < inputSize && input[inputPosition] <= ' ') inputPosition++;
+    if (inputPosition == inputSize) return false;
+
+    int length = 0;
+    while (inputPosition < inputSize && input[inputPosition] > ' ') {
+        if (length < size - 1) word[length++] = input[inputPosition];
+        inputPosition++;
+    }
+    word[length] = '\0';
+
+    return true;
+}
+#endif
+
+unsigned long long hashId(long long id) {
+    unsigned long long h = id;
+    h = (h ^ (h >> 33)) * 0xFF51AFD7ED558CCDULL;
+    h = (h ^ (h >> 33)) * 0xC4CEB9FE1A85EC53ULL;
+    return h ^ (h >> 33);
+}
+
+void allocPersonMap(unsigned long long capacity) {
+    mapMask = capacity - 1;
+    mapKey = allocate(capacity * sizeof(long long));
+    mapIndex = allocate(capacity * sizeof(int));
+    memset(mapIndex, -1, capacity * sizeof(int));
+}
+
+// Sized for every relationship joining two new people, so a batch never grows it
+void initPersonMap(int nbRelationships) {
+    unsigned long long capacity = GROWABLE_MIN;
+    while (capacity < 4ULL * nbRelationships) capacity *= 2;
+
+    allocPersonMap(capacity);
+    idsCapacity = 0;
+    ids = reserve(NULL, &idsCapacity, 2 * nbRelationships, sizeof(long long));
+    nbPersons = 0;
+}
+
+// Rehash into twice the slots
+void growPersonMap() {
+    unsigned long long oldCapacity = mapMask + 1;
+    long long* oldKey = mapKey;
+    int* oldIndex = mapIndex;
+
+    allocPersonMap(2 * oldCapacity);
+    for (unsigned long long i = 0; i < oldCapacity; i++) {
+        if (oldIndex[i] == -1) continue;
+
+        unsigned long long h = hashId(oldKey[i]) & mapMask;
+        while (mapIndex[h] != -1) h = (h + 1) & mapMask;
+        mapKey[h] = oldKey[i];
+        mapIndex[h] = oldIndex[i];
+    }
+
+    free(oldKey);
+    free(oldIndex);
+}
+
+#if QUERY_SERVER
+// Dense index of an id, -1 when it is unknown
+int findPerson(long long id) {
+    unsigned long long h = hashId(id) & mapMask;
+    while (mapIndex[h] != -1) {
+        if (mapKey[h] == id) return mapIndex[h];
+        h = (h + 1) & mapMask;
+    }
+
+    return -1;
+}
+#endif
+
+// Dense index of an id, given the next one when it is new
+int personIndex(long long id) {
+    unsigned long long h = hashId(id) & mapMask;
+    while (mapIndex[h] != -1) {
+        if (mapKey[h] == id) return mapIndex[h];
+        h = (h + 1) & mapMask;
+    }
+
+    // Keep the load under 1/2
+    if (2ULL * (nbPersons + 1) > mapMask + 1) {
+        growPersonMap();
+        h = hashId(id) & mapMask;
+        while (mapIndex[h] != -1) h = (h + 1) & mapMask;
+    }
+    ids = reserve(ids, &idsCapacity, nbPersons + 1, sizeof(long long));
+
+    mapKey[h] = id;
+    mapIndex[h] = nbPersons;
+    ids[nbPersons] = id;
+    return nbPersons++;
+}
+
+void readInput() {
+    loadInput();
+
+    long long count = 0;
+    readNumber(&count);
+    nbRelationship = count;
+    relationFrom = allocate(nbRelationship * sizeof(int));
+    relationTo = allocate(nbRelationship * sizeof(int));
+    initPersonMap(nbRelationship);
+
+    for (int i = 0; i < nbRelationship; i++) {
+        // a relationship of influence between two people (x influences y)
+        long long x;
+        long long y;
+        if (!readNumber(&x) || !readNumber(&y)) {
+            nbRelationship = i;
+            break;
+        }
+
+        relationFrom[i] = personIndex(x);
+        relationTo[i] = personIndex(y);
+    }
+}
+#endif
+
+#if ONLINE
+void initOnline() {
+    initPersonMap(0);
+    onlinePersons = NULL;
+    personCapacity = 0;
+    influences = NULL;
+    nbInfluences = 0;
+    influenceCapacity = 0;
+    undoLog = NULL;
+    undoCapacity = 0;
+    raised = NULL;
+    raisedCapacity = 0;
+    onlineMaxChain = 0;
+}
+
+int onlinePerson(long long id) {
+    int known = nbPersons;
+    int p = personIndex(id);
+    if (p == known) {
+        onlinePersons = reserve(onlinePersons, &personCapacity, p + 1, sizeof(OnlinePerson));
+        onlinePersons[p].firstInfluence = -1;
+        onlinePersons[p].depth = 1;
+        onlineMaxChain = max(onlineMaxChain, 1);
+    }
+
+    return p;
+}
+
+void raiseDepth(int p, int depth) {
+    undoLog = reserve(undoLog, &undoCapacity, nbUndo + 1, sizeof(Undo));
+    undoLog[nbUndo].person = p;
+    undoLog[nbUndo++].depth = onlinePersons[p].depth;
+    onlinePersons[p].depth = depth;
+}
+
+// Add x influences y, raising depths forward through the descendants of y only.
+// Reaching x again means the influence closes a cycle, it is then rolled back
+bool addInfluence(int x, int y) {
+    if (x == y) return false;
+
+    nbUndo = 0;
+    int nbRaised = 0;
+    int newMax = onlineMaxChain;
+    if (onlinePersons[x].depth + 1 > onlinePersons[y].depth) {
+        raiseDepth(y, onlinePersons[x].depth + 1);
+        raised = reserve(raised, &raisedCapacity, nbRaised + 1, sizeof(int));
+        raised[nbRaised++] = y;
+    }
+
+    while (nbRaised > 0) {
+        int p = raised[--nbRaised];
+        newMax = max(newMax, onlinePersons[p].depth);
+        for (int e = onlinePersons[p].firstInfluence; e != -1; e = influences[e].next) {
+            int q = influences[e].target;
+            if (onlinePersons[p].depth + 1 <= onlinePersons[q].depth) continue;
+
+            if (q == x) {
+                while (nbUndo > 0) {
+                    nbUndo--;
+                    onlinePersons[undoLog[nbUndo].person].depth = undoLog[nbUndo].depth;
+                }
+                return false;
+            }
+            raiseDepth(q, onlinePersons[p].depth + 1);
+            raised = reserve(raised, &raisedCapacity, nbRaised + 1, sizeof(int));
+            raised[nbRaised++] = q;
+        }
+    }
+
+    influences = reserve(influences, &influenceCapacity, nbInfluences + 1, sizeof(Influence));
+    influences[nbInfluences].target = y;
+    influences[nbInfluences].next = onlinePersons[x].firstInfluence;
+    onlinePersons[x].firstInfluence = nbInfluences++;
+    onlineMaxChain = newMax;
+
+    return true;
+}
+
+// One command per line: "x y" adds an influence, "?" prints the longest chain so far
+void runOnline() {
+    initOnline();
+
+    char* line = NULL;
+    size_t lineSize = 0;
+    while (getline(&line, &lineSize, stdin) != -1) {
+        char* cursor = line;
+        while (*cursor == ' ' || *cursor == '\t') cursor++;
+
+        if (*cursor == '?') {
+            printf("%d\n", onlineMaxChain);
+            fflush(stdout);
+            continue;
+        }
+
+        char* end;
+        long long x = strtoll(cursor, &end, 10);
+        if (end == cursor) continue;
+        cursor = end;
+        long long y = strtoll(cursor, &end, 10);
+        if (end == cursor) continue;
+
+        if (!addInfluence(onlinePerson(x), onlinePerson(y))) {
+            fprintf(stderr, "Rejected %lld %lld, it closes a cycle\n", x, y);
+        }
+    }
+
+    free(line);
+}
+#endif
+
+#if CONDENSE_CYCLES
+void reportCycle(int* members, int size) {
+    fprintf(stderr, "Cycle of %d people:", size);
+    for (int i = 0; i < size && i < CYCLE_REPORT_MAX; i++) {
+#if HASHED_IDS
+        fprintf(stderr, " %lld", ids[members[i]]);
+#else
+        fprintf(stderr, " %d", members[i]);
+#endif
+    }
+    fprintf(stderr, size > CYCLE_REPORT_MAX ? " ...\n" : "\n");
+}
+
+// Iterative Tarjan, the call stack keeps each node and its next edge so deep
+// chains can't overflow the stack. Returns the number of components
+int findComponents() {
+    int* index = allocate(nbNodes * sizeof(int));
+    int* low = allocate(nbNodes * sizeof(int));
+    bool* onStack = allocate(nbNodes * sizeof(bool));
+    int* stack = allocate(nbNodes * sizeof(int));
+    int* callNode = allocate(nbNodes * sizeof(int));
+    int* callEdge = allocate(nbNodes * sizeof(int));
+    component = allocate(nbNodes * sizeof(int));
+    weight = allocate(nbNodes * sizeof(int));
+
+    for (int p = 0; p < nbNodes; p++) {
+        index[p] = -1;
+        onStack[p] = false;
+    }
+
+    int nbIndexed = 0;
+    int nbStack = 0;
+    int nbComponents = 0;
+    for (int root = 0; root < nbNodes; root++) {
+        if (index[root] != -1) continue;
+
+        int nbCalls = 0;
+        int p = root;
+        while (true) {
+            // Enter p
+            index[p] = low[p] = nbIndexed++;
+            stack[nbStack++] = p;
+            onStack[p] = true;
+            callNode[nbCalls] = p;
+            callEdge[nbCalls++] = influencedStart[p];
+
+            // Walk edges until one leads to an unvisited node, or the call returns
+            p = -1;
+            while (nbCalls > 0 && p == -1) {
+                int u = callNode[nbCalls - 1];
+                if (callEdge[nbCalls - 1] < influencedStart[u + 1]) {
+                    int v = influenced[callEdge[nbCalls - 1]++];
+                    if (index[v] == -1) p = v;
+                    else if (onStack[v]) low[u] = min(low[u], index[v]);
+                    continue;
+                }
+
+                nbCalls--;
+                if (nbCalls > 0) low[callNode[nbCalls - 1]] = min(low[callNode[nbCalls - 1]], low[u]);
+                if (low[u] != index[u]) continue;
+
+                // u is the root of a component, its members are above it on the stack
+                int size = 0;
+                int v;
+                do {
+                    v = stack[--nbStack];
+                    onStack[v] = false;
+                    component[v] = nbComponents;
+                    size++;
+                } while (v != u);
+                weight[nbComponents++] = size;
+                if (size > 1) reportCycle(&stack[nbStack], size);
+            }
+            if (p == -1) break;
+        }
+    }
+
+    free(index);
+    free(low);
+    free(onStack);
+    free(stack);
+    free(callNode);
+    free(callEdge);
+
+    return nbComponents;
+}
+
+// Replace each cycle by one node weighing its size, and drop people influencing
+// themselves, so the graph is a DAG. Without either people stay the nodes and
+// the adjacency is kept
+void condenseCycles() {
+    int nbComponents = findComponents();
+
+    int count = 0;
+    for (int p = 0; p < nbNodes; p++) {
+        for (int i = influencedStart[p]; i < influencedStart[p + 1]; i++) {
+            if (component[p] != component[influenced[i]]) count++;
+        }
+    }
+    if (count == nbRelationship) {
+        for (int p = 0; p < nbNodes; p++) {
+            component[p] = p;
+            weight[p] = 1;
+        }
+        return;
+    }
+
+    count = 0;
+    relationFrom = allocate(nbRelationship * sizeof(int));
+    relationTo = allocate(nbRelationship * sizeof(int));
+    for (int p = 0; p < nbNodes; p++) {
+        for (int i = influencedStart[p]; i < influencedStart[p + 1]; i++) {
+            if (component[p] == component[influenced[i]]) continue;
+
+            relationFrom[count] = component[p];
+            relationTo[count++] = component[influenced[i]];
+        }
+    }
+
+    free(influencedStart);
+    free(influenced);
+    free(influencedByStart);
+    free(influencedBy);
+
+    nbNodes = nbComponents;
+    nbRelationship = count;
+    buildGraph();
+}
+#endif
+
+#if TOPOLOGICAL_DP
+// Kahn's algorithm, people left out of the order are on a cycle
+void computeOrder() {
+    int* inDegree = allocate(nbNodes * sizeof(int));
+    order = allocate(nbNodes * sizeof(int));
+
+    nbOrdered = 0;
+    for (int p = 0; p < nbNodes; p++) {
+        inDegree[p] = influencedByStart[p + 1] - influencedByStart[p];
+        if (inDegree[p] == 0) order[nbOrdered++] = p;
+    }
+
+    for (int head = 0; head < nbOrdered; head++) {
+        int p = order[head];
+        for (int i = influencedStart[p]; i < influencedStart[p + 1]; i++) {
+            if (--inDegree[influenced[i]] == 0) order[nbOrdered++] = influenced[i];
+        }
+    }
+
+    if (nbOrdered < nbNodes) {
+        fprintf(stderr, "%d people are on a cycle of influence\n", nbNodes - nbOrdered);
+    }
+
+    free(inDegree);
+}
+
+// Max-accumulate depths along the order, forward then backward
+void computeDepths() {
+    depthTo = allocate(nbNodes * sizeof(int));
+    depthFrom = allocate(nbNodes * sizeof(int));
+    for (int p = 0; p < nbNodes; p++) {
+        depthTo[p] = NODE_WEIGHT(p);
+        depthFrom[p] = NODE_WEIGHT(p);
+    }
+
+    for (int k = 0; k < nbOrdered; k++) {
+        int p = order[k];
+        for (int i = influencedStart[p]; i < influencedStart[p + 1]; i++) {
+            int q = influenced[i];
+            depthTo[q] = max(depthTo[q], depthTo[p] + NODE_WEIGHT(q));
+        }
+    }
+
+    for (int k = nbOrdered - 1; k >= 0; k--) {
+        int p = order[k];
+        for (int i = influencedStart[p]; i < influencedStart[p + 1]; i++) {
+            depthFrom[p] = max(depthFrom[p], depthFrom[influenced[i]] + NODE_WEIGHT(p));
+        }
+    }
+}
+#else
+int nbChainFromPerson(int person, int depth) {
     int chain = depth;
-    for (int i = 0; i < person->nbInfluenced; i++) {
-        chain = max(nbChainFromPerson(person->influenced[i], depth + 1), depth);
+    for (int i = influencedStart[person]; i < influencedStart[person + 1]; i++) {
+        chain = max(nbChainFromPerson(influenced[i], depth + 1), depth);
     }
 
     return chain;
 }
 
-int nbChainToPerson(Person* person, int depth) {
+int nbChainToPerson(int person, int depth) {
     int chain = depth;
-    for (int i = 0; i < person->nbInfluencedBy; i++) {
-        chain = max(nbChainToPerson(person->influencedBy[i], depth + 1), depth);
+    for (int i = influencedByStart[person]; i < influencedByStart[person + 1]; i++) {
+        chain = max(nbChainToPerson(influencedBy[i], depth + 1), depth);
     }
 
     return chain;
 }
+#endif
+
+#if PARALLEL
+void publishReady(LevelPass* pass, int* ready, int nbReady) {
+    int k = atomic_fetch_add(&pass->nbOrdered, nbReady);
+    memcpy(&pass->order[k], ready, nbReady * sizeof(int));
+}
+
+// Each level is split in chunks taken from an atomic index. The thread that
+// removes the last predecessor of a person owns it, and reads the depths of
+// all predecessors, settled in earlier levels, so its depth is written once
+void* levelWorker(void* arg) {
+    LevelPass* pass = arg;
+    int ready[READY_BUFFER];
+
+    while (true) {
+        int nbReady = 0;
+        int k;
+        while ((k = atomic_fetch_add(&pass->next, LEVEL_CHUNK)) < pass->levelEnd) {
+            int end = k + LEVEL_CHUNK < pass->levelEnd ? k + LEVEL_CHUNK : pass->levelEnd;
+            for (; k < end; k++) {
+                int p = pass->order[k];
+                for (int i = pass->start[p]; i < pass->start[p + 1]; i++) {
+                    int q = pass->adjacency[i];
+                    if (atomic_fetch_sub_explicit(&pass->degree[q], 1, memory_order_acq_rel) == 1) {
+                        int best = 0;
+                        for (int j = pass->reverseStart[q]; j < pass->reverseStart[q + 1]; j++) {
+                            best = max(best, pass->depth[pass->reverseAdjacency[j]]);
+                        }
+                        pass->depth[q] = best + NODE_WEIGHT(q);
+                        ready[nbReady++] = q;
+                        if (nbReady == READY_BUFFER) {
+                            publishReady(pass, ready, nbReady);
+                            nbReady = 0;
+                        }
+                    }
+                }
+            }
+        }
+        if (nbReady > 0) publishReady(pass, ready, nbReady);
+
+        // One thread moves on to the next level while the others wait
+        if (pthread_barrier_wait(&pass->barrier) == PTHREAD_BARRIER_SERIAL_THREAD) {
+            pass->levelStart = pass->levelEnd;
+            pass->levelEnd = atomic_load(&pass->nbOrdered);
+            atomic_store(&pass->next, pass->levelStart);
+        }
+        pthread_barrier_wait(&pass->barrier);
+
+        if (pass->levelStart == pass->levelEnd) break;
+    }
+
+    return NULL;
+}
+
+// depth[p] = people in the longest chain reaching p in this direction
+void runLevelPass(LevelPass* pass, int* start, int* adjacency, int* reverseStart, int* reverseAdjacency, int* order, int* depth, int nbThreads) {
+    pass->start = start;
+    pass->adjacency = adjacency;
+    pass->reverseStart = reverseStart;
+    pass->reverseAdjacency = reverseAdjacency;
+    pass->degree = allocate(nbNodes * sizeof(atomic_int));
+    pass->order = order;
+    pass->depth = depth;
+
+    int nbSources = 0;
+    for (int p = 0; p < nbNodes; p++) {
+        atomic_init(&pass->degree[p], reverseStart[p + 1] - reverseStart[p]);
+        depth[p] = NODE_WEIGHT(p);
+        if (reverseStart[p + 1] == reverseStart[p]) order[nbSources++] = p;
+    }
+    atomic_init(&pass->next, 0);
+    atomic_init(&pass->nbOrdered, nbSources);
+    pass->levelStart = 0;
+    pass->levelEnd = nbSources;
+
+    pthread_t threads[NB_THREADS];
+    pthread_barrier_init(&pass->barrier, NULL, nbThreads);
+    for (int t = 1; t < nbThreads; t++) {
+        pthread_create(&threads[t], NULL, levelWorker, pass);
+    }
+    levelWorker(pass);
+    for (int t = 1; t < nbThreads; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    pthread_barrier_destroy(&pass->barrier);
+
+    free(pass->degree);
+}
+
+// Same depths as computeOrder() and computeDepths(), the order is level by level
+void computeDepthsParallel(int nbThreads) {
+    LevelPass pass;
+    order = allocate(nbNodes * sizeof(int));
+    depthTo = allocate(nbNodes * sizeof(int));
+    depthFrom = allocate(nbNodes * sizeof(int));
+
+    runLevelPass(&pass, influencedStart, influenced, influencedByStart, influencedBy, order, depthTo, nbThreads);
+    nbOrdered = atomic_load(&pass.nbOrdered);
+    if (nbOrdered < nbNodes) {
+        fprintf(stderr, "%d people are on a cycle of influence\n", nbNodes - nbOrdered);
+    }
+
+    int* reverseOrder = allocate(nbNodes * sizeof(int));
+    runLevelPass(&pass, influencedByStart, influencedBy, influencedStart, influenced, reverseOrder, depthFrom, nbThreads);
+    free(reverseOrder);
+}
+#endif
+
+#if QUERY_SERVER
+int chainThrough(int p) {
+    int node = NODE_OF(p);
+    return depthTo[node] + depthFrom[node] - NODE_WEIGHT(node);
+}
+
+// Counting sort on the chain through each person, it is at most nbPersons
+void rankPersons() {
+    int* count = allocate((nbPersons + 2) * sizeof(int));
+    memset(count, 0, (nbPersons + 2) * sizeof(int));
+    for (int p = 0; p < nbPersons; p++) {
+        count[nbPersons - chainThrough(p) + 1]++;
+    }
+    for (int c = 0; c <= nbPersons; c++) {
+        count[c + 1] += count[c];
+    }
+
+    ranked = allocate(nbPersons * sizeof(int));
+    for (int p = 0; p < nbPersons; p++) {
+        ranked[count[nbPersons - chainThrough(p)]++] = p;
+    }
+
+    free(count);
+}
+
+// One query per line: "THROUGH id", "FROM id" and "TO id" print the longest chain
+// through, starting with or ending with id, 0 for an unknown id. "TOP k" prints
+// the k people with the longest chains through them, one "id chain" per line
+void runQueries() {
+    char command[QUERY_WORD];
+    while (readWord(command, QUERY_WORD)) {
+        long long argument;
+        if (!readNumber(&argument)) {
+            fprintf(stderr, "Missing argument for %s\n", command);
+            break;
+        }
+
+        if (strcmp(command, "TOP") == 0) {
+            int k = argument < nbPersons ? argument : nbPersons;
+            for (int i = 0; i < k; i++) {
+                printf("%lld %d\n", ids[ranked[i]], chainThrough(ranked[i]));
+            }
+            continue;
+        }
+
+        int p = findPerson(argument);
+        if (strcmp(command, "THROUGH") == 0) {
+            printf("%d\n", p == -1 ? 0 : chainThrough(p));
+        } else if (strcmp(command, "FROM") == 0) {
+            printf("%d\n", p == -1 ? 0 : depthFrom[NODE_OF(p)]);
+        } else if (strcmp(command, "TO") == 0) {
+            printf("%d\n", p == -1 ? 0 : depthTo[NODE_OF(p)]);
+        } else {
+            fprintf(stderr, "Unknown query %s\n", command);
+        }
+    }
+}
+#endif
+
+#if BENCHMARK
+// Random DAG, every relationship goes from a lower to a higher id
+void generateGraph() {
+    srand(BENCHMARK_SEED);
+    nbRelationship = BENCHMARK_NB_RELATIONSHIPS;
+    relationFrom = allocate(nbRelationship * sizeof(int));
+    relationTo = allocate(nbRelationship * sizeof(int));
+    for (int i = 0; i < nbRelationship; i++) {
+        int x = rand() % (BENCHMARK_NB_PERSONS - 1);
+        int y = x + 1 + rand() % BENCHMARK_SPAN;
+        relationFrom[i] = x;
+        relationTo[i] = y < BENCHMARK_NB_PERSONS ? y : BENCHMARK_NB_PERSONS - 1;
+    }
+    nbPersons = BENCHMARK_NB_PERSONS;
+    nbNodes = nbPersons;
+}
+
+void freeDepths() {
+    free(order);
+    free(depthTo);
+    free(depthFrom);
+}
+
+void runBenchmark() {
+    generateGraph();
+    buildGraph();
+#if CONDENSE_CYCLES
+    condenseCycles();
+#endif
+
+    GET_TIME;
+    START_TIME;
+    computeOrder();
+    computeDepths();
+    GET_TIME;
+    double sequentialTime = ELAPSED_TIME;
+    int* expectedTo = depthTo;
+    int* expectedFrom = depthFrom;
+    free(order);
+
+    int maxChain = 0;
+    for (int p = 0; p < nbNodes; p++) {
+        maxChain = max(expectedTo[p] + expectedFrom[p] - NODE_WEIGHT(p), maxChain);
+    }
+    printf("persons %d relationships %d longest chain %d\n", nbNodes, nbRelationship, maxChain);
+    printf("sequential %.1f ms\n", sequentialTime);
+
+    for (int t = 1; t <= NB_THREADS; t++) {
+        GET_TIME;
+        START_TIME;
+        computeDepthsParallel(t);
+        GET_TIME;
+        double elapsed = ELAPSED_TIME;
+
+        bool identical = memcmp(depthTo, expectedTo, nbNodes * sizeof(int)) == 0
+            && memcmp(depthFrom, expectedFrom, nbNodes * sizeof(int)) == 0;
+        printf("threads %d %.1f ms speedup %.2f %s\n", t, elapsed, sequentialTime / elapsed, identical ? "identical" : "MISMATCH");
+        freeDepths();
+    }
+
+    free(expectedTo);
+    free(expectedFrom);
+}
+#endif
 
 //MAIN
 int main() {
-    // Init persons
-    for (int i = 0; i < NB_PEOPLE_MAX; i++) {
-        Person* p = &persons[i];
-        p->id = i;
-        p->nbInfluenced = 0;
-        p->nbInfluencedBy = 0;
-    }
+#if BENCHMARK
+    runBenchmark();
+    return 0;
+#endif
+#if ONLINE
+    runOnline();
+    return 0;
+#endif
 
-    firstPerson = INF_MAX;
+#if HASHED_IDS
+    readInput();
+#else
     lastPerson = INF_MIN;
     scanf("%d", &nbRelationship);
+    relationFrom = allocate(nbRelationship * sizeof(int));
+    relationTo = allocate(nbRelationship * sizeof(int));
     for (int i = 0; i < nbRelationship; i++) {
         // a relationship of influence between two people (x influences y)
         int x;
         int y;
         scanf("%d%d", &x, &y);
-    
-        Person* px = &persons[x];
-        Person* py = &persons[y];
 
-        px->influenced[px->nbInfluenced++] = py;
-        py->influencedBy[py->nbInfluencedBy++] = px;
+        relationFrom[i] = x;
+        relationTo[i] = y;
 
         if (x > lastPerson) lastPerson = x;
         if (y > lastPerson) lastPerson = y;
-        if (x < firstPerson) firstPerson = x;
-        if (y < firstPerson) firstPerson = y;
     }
+    nbPersons = lastPerson + 1;
+#endif
+
+    nbNodes = nbPersons;
+    buildGraph();
+#if CONDENSE_CYCLES
+    condenseCycles();
+#endif
 
     int maxChain = 0;
-    for (int i = firstPerson; i < lastPerson; i++) {
-        Person* p = &persons[i];
-        maxChain = max(nbChainToPerson(p, 0) + nbChainFromPerson(p, 1), maxChain);
+#if PARALLEL
+    computeDepthsParallel(NB_THREADS);
+#elif TOPOLOGICAL_DP
+    computeOrder();
+    computeDepths();
+#endif
+#if QUERY_SERVER
+    rankPersons();
+    runQueries();
+    return 0;
+#endif
+#if TOPOLOGICAL_DP
+    for (int p = 0; p < nbNodes; p++) {
+        maxChain = max(depthTo[p] + depthFrom[p] - NODE_WEIGHT(p), maxChain);
+    }
+#else
+    for (int i = 0; i < nbNodes; i++) {
+        maxChain = max(nbChainToPerson(i, 0) + nbChainFromPerson(i, 1), maxChain);
     }
+#endif
 
     // The number of people involved in the longest succession of influences
     printf("%d\n", maxChain);